@@ -9,12 +9,19 @@
 #pragma warning(disable: 4548)
 #include "clang/Tooling/CommonOptionsParser.h"
 #include "clang/Tooling/Tooling.h"
+#include "clang/Frontend/ASTUnit.h"
 #pragma warning(pop)
 
 #include <iostream>
 #include <fstream>
+#include <ciso646>
 
+#include "CPP2DAnalyzer.h"
+#include "CPP2DASTFile.h"
 #include "CPP2DFrontendAction.h"
+#include "CPP2DWatch.h"
+#include "Options.h"
+#include "SymbolIndex.h"
 
 using namespace clang::tooling;
 using namespace llvm;
@@ -36,6 +43,74 @@ cl::list<std::string> MacroAsStmt(
   cl::cat(cpp2dCategory),
   cl::ZeroOrMore);
 
+cl::opt<bool> EmitAST(
+  "emit-ast",
+  cl::desc("Do not print the D code, but save the AST (<module>.ast) and the preprocessor data "
+           "(<module>.cpp2d), to print them later with --from-ast"),
+  cl::cat(cpp2dCategory));
+
+cl::opt<bool> Analyze(
+  "analyze",
+  cl::desc("Do not print the D code, but list the constructs which can't be converted, "
+           "one per line : <file>:<line>:<column>: <kind>: <message>. Exit with 1 if any"),
+  cl::cat(cpp2dCategory));
+
+cl::opt<bool> FromAST(
+  "from-ast",
+  cl::desc("Source files are AST files saved with --emit-ast. Each one is printed independently"),
+  cl::cat(cpp2dCategory));
+
+cl::opt<bool> Incremental(
+  "incremental",
+  cl::desc("Save the D code of each declaration in <module>.dcache, "
+           "and print again only the changed declarations"),
+  cl::cat(cpp2dCategory));
+
+cl::opt<unsigned> PrintJobs(
+  "print-jobs",
+  cl::desc("Print the declarations of each module with N processes (not under Windows)"),
+  cl::value_desc("N"),
+  cl::init(1),
+  cl::cat(cpp2dCategory));
+
+cl::opt<bool> ValueClasses(
+  "value-classes",
+  cl::desc("Print as struct the classes which are never used polymorphically, never pointed "
+           "and never allocated by new. Needs --index, to know their usage in other sources"),
+  cl::cat(cpp2dCategory));
+
+cl::opt<bool> MutableStrings(
+  "mutable-strings",
+  cl::desc("Print as char[] the local strings which are appended, reserved or assigned by index, "
+           "and convert them to string only when they are copied or returned"),
+  cl::cat(cpp2dCategory));
+
+cl::opt<bool> UniqueOwner(
+  "unique-owner",
+  cl::desc("Allocate by malloc, out of the GC heap, the structs and arrays created by new and "
+           "std::make_unique. std::unique_ptr and delete free them"),
+  cl::cat(cpp2dCategory));
+
+cl::opt<bool> Watch(
+  "watch",
+  cl::desc("After the conversion, wait for changes in the sources and their includes, "
+           "and convert again the changed sources (Linux only)"),
+  cl::cat(cpp2dCategory));
+
+cl::opt<std::string> BuildIndex(
+  "build-index",
+  cl::desc("Do not print the D code, but write the index of the free operators, hash traits, "
+           "derived classes and pointers of all records found in the source files"),
+  cl::value_desc("index file"),
+  cl::cat(cpp2dCategory));
+
+cl::opt<std::string> IndexFile(
+  "index",
+  cl::desc("Index written by --build-index, to know the operators and hash traits "
+           "declared in other modules"),
+  cl::value_desc("index file"),
+  cl::cat(cpp2dCategory));
+
 
 //! Used to add fake options to the compiler
 //!  - For example : -fno-delayed-template-parsing
@@ -80,8 +155,69 @@ int main(int argc, char const** argv)
 	argc = static_cast<int>(argv_vect.size());
 	CommonOptionsParser OptionsParser(argc, argv_vect.data(), cpp2dCategory);
 	CPP2DCompilationDatabase compilationDatabase(OptionsParser.getCompilations());
+	Options::getInstance().valueClasses = ValueClasses;
+	Options::getInstance().mutableStrings = MutableStrings;
+	Options::getInstance().uniqueOwner = UniqueOwner;
+	if(not BuildIndex.empty())
+	{
+		SymbolIndexBuilder builder;
+		int result = 0;
+		if(FromAST)
+		{
+			for(std::string const& astFile : OptionsParser.getSourcePathList())
+			{
+				if(std::unique_ptr<ASTUnit> ast = loadASTFile(astFile))
+					builder.collect(ast->getASTContext());
+				else
+					result = 1;
+			}
+		}
+		else
+		{
+			ClangTool Tool(
+			  compilationDatabase,
+			  OptionsParser.getSourcePathList());
+			result = Tool.run(newFrontendActionFactory(&builder).get());
+		}
+		if(not builder.write(BuildIndex))
+		{
+			llvm::errs() << "Can't write the index file " << BuildIndex << "\n";
+			return 1;
+		}
+		return result;
+	}
+	// A class pointed only in an other source would be a struct here, and a class there
+	if(ValueClasses and IndexFile.empty())
+	{
+		llvm::errs() << "-value-classes needs the index of the whole project (-index)\n";
+		return 1;
+	}
+	if(not IndexFile.empty() and not SymbolIndex::getInstance().load(IndexFile))
+	{
+		llvm::errs() << "Can't load the index file " << IndexFile << "\n";
+		return 1;
+	}
+	if(FromAST and Analyze)
+	{
+		llvm::errs() << "-analyze needs the sources, it can't be used with -from-ast\n";
+		return 1;
+	}
+	if(FromAST)
+	{
+		int result = 0;
+		for(std::string const& astFile : OptionsParser.getSourcePathList())
+			result |= printASTFile(astFile);
+		return result;
+	}
 	ClangTool Tool(
 	  compilationDatabase,
 	  OptionsParser.getSourcePathList());
-	return Tool.run(newFrontendActionFactory<CPP2DFrontendAction>().get());
+	IncludeGraph includeGraph;
+	CPP2DFrontendActionFactory factory(Watch ? &includeGraph : nullptr);
+	int const result = Tool.run(&factory);
+	if(Watch)
+		return watchSources(compilationDatabase, OptionsParser.getSourcePathList(), includeGraph);
+	if(Analyze and getTotalIssueCount() != 0)
+		return 1; // To fail the CI
+	return result;
 }
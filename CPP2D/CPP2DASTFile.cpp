@@ -0,0 +1,206 @@
+//
+// Copyright (c) 2016 Loïc HAMOT
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "CPP2DASTFile.h"
+#include "CPP2DConsumer.h"
+#include "CPP2DPPHandling.h"
+#include "CPP2DTools.h"
+
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <ciso646>
+
+#pragma warning(push, 0)
+#include <clang/Frontend/ASTUnit.h>
+#include <clang/Frontend/CompilerInstance.h>
+#include <clang/Frontend/MultiplexConsumer.h>
+#include <clang/Frontend/PCHContainerOperations.h>
+#include <clang/Lex/Preprocessor.h>
+#include <clang/Serialization/ASTWriter.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/Path.h>
+#pragma warning(pop)
+
+using namespace clang;
+
+namespace
+{
+char const* const PPDataHeader = "cpp2d-ppdata 2";
+
+//! Data of the CPP2DPPHandling, as stored in the <module>.cpp2d file
+struct PPData
+{
+	std::string sourceFile;
+	std::set<std::string> includes;
+	std::vector<std::pair<std::string, std::string>> includedModules; //!< file path => D module
+	std::set<std::string> insertedBeforeDecls;
+};
+
+bool readPPData(std::string const& path, PPData& data)
+{
+	std::ifstream file(path, std::ios::binary);
+	std::string header;
+	if(not std::getline(file, header) or header != PPDataHeader)
+		return false;
+	if(not CPP2DTools::readString(file, data.sourceFile))
+		return false;
+	size_t count = 0;
+	std::string str;
+	if(not(file >> count))
+		return false;
+	for(size_t i = 0; i < count; ++i)
+	{
+		if(not CPP2DTools::readString(file, str))
+			return false;
+		data.includes.insert(str);
+	}
+	if(not(file >> count))
+		return false;
+	for(size_t i = 0; i < count; ++i)
+	{
+		std::string module;
+		if(not CPP2DTools::readString(file, str) or not CPP2DTools::readString(file, module))
+			return false;
+		data.includedModules.emplace_back(str, module);
+	}
+	if(not(file >> count))
+		return false;
+	for(size_t i = 0; i < count; ++i)
+	{
+		if(not CPP2DTools::readString(file, str))
+			return false;
+		data.insertedBeforeDecls.insert(str);
+	}
+	return true;
+}
+
+//! Save the data of the CPP2DPPHandling at the end of the translation unit
+class PPDataWriter : public ASTConsumer
+{
+public:
+	PPDataWriter(std::string const& sourceFile,
+	             std::string const& path,
+	             CPP2DPPHandling* ppHandling)
+		: sourceFile(sourceFile)
+		, path(path)
+		, ppHandling(ppHandling)
+	{
+	}
+
+	void HandleTranslationUnit(ASTContext& context) override
+	{
+		std::ofstream file(path, std::ios::binary);
+		file << PPDataHeader << '\n';
+		CPP2DTools::writeString(file, sourceFile);
+		file << ppHandling->getIncludes().size() << '\n';
+		for(std::string const& include : ppHandling->getIncludes())
+			CPP2DTools::writeString(file, include);
+		file << ppHandling->getIncludedModules().size() << '\n';
+		for(auto const& file_n_module : ppHandling->getIncludedModules())
+		{
+			// The name is relative to the compile directory, but the AST can be loaded from anywhere
+			llvm::SmallString<256> filePath(file_n_module.first->tryGetRealPathName());
+			if(filePath.empty())
+			{
+				filePath = file_n_module.first->getName();
+				context.getSourceManager().getFileManager().makeAbsolutePath(filePath);
+			}
+			CPP2DTools::writeString(file, filePath.str().str());
+			CPP2DTools::writeString(file, file_n_module.second);
+		}
+		file << ppHandling->getInsertedBeforeDecls().size() << '\n';
+		for(std::string const& code : ppHandling->getInsertedBeforeDecls())
+			CPP2DTools::writeString(file, code);
+	}
+
+private:
+	std::string sourceFile;
+	std::string path;
+	CPP2DPPHandling* ppHandling;
+};
+}
+
+std::unique_ptr<ASTConsumer> createASTFileWriter(
+  CompilerInstance& compiler,
+  llvm::StringRef inFile,
+  CPP2DPPHandling* ppHandling)
+{
+	std::string const modulename = llvm::sys::path::stem(inFile).str();
+	std::string const astFile = modulename + ".ast";
+	std::unique_ptr<llvm::raw_pwrite_stream> os = compiler.createOutputFile(
+	      astFile,
+	      true,	//Binary
+	      false,	//RemoveFileOnSignal
+	      inFile,
+	      "",		//Extension
+	      true);	//UseTemporary
+	if(not os)
+		return nullptr;
+
+	// Same as clang -emit-ast, but keep the translation unit complete
+	//  (The pending template instantiations are needed to print the D code)
+	auto buffer = std::make_shared<PCHBuffer>();
+	std::vector<std::unique_ptr<ASTConsumer>> consumers;
+	consumers.push_back(std::make_unique<PCHGenerator>(
+	                      compiler.getPreprocessor(),
+	                      astFile,
+	                      "",	//isysroot
+	                      buffer,
+	                      ArrayRef<std::shared_ptr<ModuleFileExtension>>()));
+	consumers.push_back(compiler.getPCHContainerWriter().CreatePCHContainerGenerator(
+	                      compiler, inFile.str(), astFile, std::move(os), buffer));
+	consumers.push_back(std::make_unique<PPDataWriter>(
+	                      inFile.str(), modulename + ".cpp2d", ppHandling));
+	return std::make_unique<MultiplexConsumer>(std::move(consumers));
+}
+
+std::unique_ptr<ASTUnit> loadASTFile(std::string const& astFile)
+{
+	// The ASTReader map the file in memory and deserialize the declarations lazily
+	//  (It keep a reference on the pchReader)
+	static RawPCHContainerReader const pchReader;
+	std::unique_ptr<ASTUnit> ast = ASTUnit::LoadFromASTFile(
+	                                 astFile,
+	                                 pchReader,
+	                                 ASTUnit::LoadASTOnly,
+	                                 CompilerInstance::createDiagnostics(new DiagnosticOptions()),
+	                                 FileSystemOptions());
+	if(not ast)
+		llvm::errs() << "Can't load the AST file " << astFile << "\n";
+	return ast;
+}
+
+int printASTFile(std::string const& astFile)
+{
+	llvm::SmallString<256> ppDataFile(astFile);
+	llvm::sys::path::replace_extension(ppDataFile, "cpp2d");
+	PPData data;
+	if(not readPPData(ppDataFile.str().str(), data))
+	{
+		llvm::errs() << "Can't read the preprocessor data " << ppDataFile
+		             << " of the AST file " << astFile << "\n";
+		return 1;
+	}
+
+	std::unique_ptr<ASTUnit> ast = loadASTFile(astFile);
+	if(not ast)
+		return 1;
+
+	// FileEntry are unique in a FileManager, so they can be found back by path
+	std::unordered_map<FileEntry const*, std::string> includedModules;
+	for(auto const& path_n_module : data.includedModules)
+	{
+		if(FileEntry const* entry = ast->getFileManager().getFile(path_n_module.first))
+			includedModules.emplace(entry, path_n_module.second);
+	}
+
+	ASTContext& context = ast->getASTContext();
+	CPP2DConsumer consumer(context, data.sourceFile);
+	consumer.printDModule(context, data.includes, includedModules, data.insertedBeforeDecls);
+	return 0;
+}
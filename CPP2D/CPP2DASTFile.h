@@ -0,0 +1,40 @@
+//
+// Copyright (c) 2016 Loïc HAMOT
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <memory>
+#include <string>
+
+#pragma warning(push, 0)
+#include <llvm/ADT/StringRef.h>
+#pragma warning(pop)
+
+namespace clang
+{
+class ASTConsumer;
+class ASTUnit;
+class CompilerInstance;
+}
+
+class CPP2DPPHandling;
+
+//! @brief Create a consumer which save the translation unit instead of printing it
+//!
+//! Two files are written in the current directory :
+//!  - <module>.ast : The serialized AST, with the macros already transformed
+//!  - <module>.cpp2d : The data of the CPP2DPPHandling needed to print the D module
+std::unique_ptr<clang::ASTConsumer> createASTFileWriter(
+  clang::CompilerInstance& compiler,
+  llvm::StringRef inFile,
+  CPP2DPPHandling* ppHandling);
+
+//! Load an AST file written by createASTFileWriter (nullptr on failure)
+std::unique_ptr<clang::ASTUnit> loadASTFile(std::string const& astFile);
+
+//! @brief Load an AST file written by createASTFileWriter, and print its D module
+//! @return 0 on success
+int printASTFile(std::string const& astFile);
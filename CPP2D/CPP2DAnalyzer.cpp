@@ -0,0 +1,282 @@
+//
+// Copyright (c) 2016 Loïc HAMOT
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "CPP2DAnalyzer.h"
+#include "CPP2DPPHandling.h"
+#include "CPP2DTools.h"
+#include "DPrinter.h"
+#include "MatchContainer.h"
+#include "Options.h"
+#include "SymbolIndex.h"
+
+#include <type_traits>
+#include <ciso646>
+
+#pragma warning(push, 0)
+#include <clang/AST/ASTConsumer.h>
+#pragma warning(disable: 4265)
+#include <clang/ASTMatchers/ASTMatchFinder.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+#pragma warning(pop)
+
+using namespace clang;
+
+namespace
+{
+typedef RecursiveASTVisitor<DPrinter> DPrinterBase;
+
+size_t totalIssueCount = 0; //!< Reported in all analyzed modules
+
+//! True if the DPrinter has a Traverse method for this kind of Decl (else it print a comment)
+bool isPrinted(Decl::Kind kind)
+{
+	switch(kind)
+	{
+#define ABSTRACT_DECL(DECL)
+#define DECL(CLASS, BASE)                                                  \
+	case Decl::CLASS:                                                      \
+		return not std::is_same<decltype(&DPrinter::Traverse##CLASS##Decl), \
+		       decltype(&DPrinterBase::Traverse##CLASS##Decl)>::value;
+#include <clang/AST/DeclNodes.inc>
+	}
+	return false;
+}
+
+//! True if the DPrinter has a Traverse method for this kind of Stmt (else it print a comment)
+bool isPrinted(Stmt::StmtClass kind)
+{
+	switch(kind)
+	{
+	case Stmt::NoStmtClass:
+		return false;
+#define ABSTRACT_STMT(STMT)
+#define STMT(CLASS, PARENT)                                         \
+	case Stmt::CLASS##Class:                                        \
+		return not std::is_same<decltype(&DPrinter::Traverse##CLASS), \
+		       decltype(&DPrinterBase::Traverse##CLASS)>::value;
+#include <clang/AST/StmtNodes.inc>
+	}
+	return false;
+}
+
+//! True if the DPrinter has a Traverse method for this kind of Type (else it print a comment)
+bool isPrinted(clang::Type::TypeClass kind)
+{
+	switch(kind)
+	{
+#define ABSTRACT_TYPE(CLASS, BASE)
+#define TYPE(CLASS, BASE)                                                  \
+	case clang::Type::CLASS:                                               \
+		return not std::is_same<decltype(&DPrinter::Traverse##CLASS##Type), \
+		       decltype(&DPrinterBase::Traverse##CLASS##Type)>::value;
+#include <clang/AST/TypeNodes.def>
+	}
+	return false;
+}
+
+//! Run the matchers, then the CPP2DAnalyzer, without printing anything but the report
+class AnalyzerConsumer : public ASTConsumer
+{
+public:
+	AnalyzerConsumer(llvm::StringRef inFile, CPP2DPPHandling* ppHandling)
+		: modulename(llvm::sys::path::stem(inFile).str())
+		, ppHandling(ppHandling)
+	{
+	}
+
+	void HandleTranslationUnit(ASTContext& context) override
+	{
+		if(Options::getInstance().valueClasses or SymbolIndex::getInstance().isLoaded())
+			SymbolIndex::getInstance().collectTranslationUnit(context);
+		receiver.registerMatchers(finder, ppHandling->getIncludes());
+		receiver.matchModuleDecls(finder, context, modulename);
+		// No DPrinter is created, but its traits are used (keyed by pointers of this context)
+		DPrinter::clearTraitsCaches();
+		CPP2DAnalyzer analyzer(context, receiver, modulename);
+		analyzer.analyze();
+		totalIssueCount += analyzer.getIssueCount();
+		DPrinter::clearTraitsCaches();
+	}
+
+private:
+	MatchContainer receiver;
+	ast_matchers::MatchFinder finder;
+	std::string modulename;
+	CPP2DPPHandling* ppHandling;
+};
+}
+
+CPP2DAnalyzer::CPP2DAnalyzer(ASTContext& context, MatchContainer& receiver, std::string modulename)
+	: context(context)
+	, receiver(receiver)
+	, modulename(std::move(modulename))
+{
+}
+
+void CPP2DAnalyzer::analyze()
+{
+	for(Decl* decl : context.getTranslationUnitDecl()->decls())
+	{
+		if(CPP2DTools::checkFilename(context.getSourceManager(), modulename, decl))
+			TraverseDecl(decl);
+	}
+	llvm::outs().flush();
+}
+
+bool CPP2DAnalyzer::TraverseDecl(Decl* decl)
+{
+	if(decl == nullptr)
+		return true;
+	currentLoc = decl->getLocation();
+	if(receiver.getPrinter(decl))
+		return true;
+	return Base::TraverseDecl(decl);
+}
+
+bool CPP2DAnalyzer::TraverseStmt(Stmt* stmt)
+{
+	if(stmt == nullptr)
+		return true;
+	currentLoc = stmt->getLocStart();
+	if(receiver.getPrinter(stmt))
+		return true;
+	return Base::TraverseStmt(stmt);
+}
+
+bool CPP2DAnalyzer::TraverseType(QualType type)
+{
+	if(type.isNull() or receiver.getPrinter(type.getTypePtr()))
+		return true;
+	return Base::TraverseType(type);
+}
+
+bool CPP2DAnalyzer::TraverseTypeLoc(TypeLoc typeLoc)
+{
+	if(typeLoc.isNull())
+		return true;
+	currentLoc = typeLoc.getBeginLoc();
+	if(receiver.getPrinter(typeLoc.getTypePtr()))
+		return true;
+	return Base::TraverseTypeLoc(typeLoc);
+}
+
+bool CPP2DAnalyzer::VisitDecl(Decl* decl)
+{
+	if(not isPrinted(decl->getKind()))
+		report(decl->getLocation(), "unhandled-decl", std::string(decl->getDeclKindName()) + " Decl");
+	return true;
+}
+
+bool CPP2DAnalyzer::VisitStmt(Stmt* stmt)
+{
+	if(not isPrinted(stmt->getStmtClass()))
+		report(stmt->getLocStart(), "unhandled-stmt", stmt->getStmtClassName());
+	return true;
+}
+
+bool CPP2DAnalyzer::VisitType(clang::Type* type)
+{
+	if(not isPrinted(type->getTypeClass()))
+		report(currentLoc, "unhandled-type", std::string(type->getTypeClassName()) + "Type");
+	return true;
+}
+
+bool CPP2DAnalyzer::VisitFieldDecl(FieldDecl* decl)
+{
+	std::string const varName = decl->getNameAsString();
+	if(varName.find("CPP2D_MACRO_STMT") == 0 and not decl->hasInClassInitializer())
+		report(decl->getLocation(), "macro-stmt-no-init", varName + " has no in-class initializer");
+	return true;
+}
+
+bool CPP2DAnalyzer::VisitCXXRecordDecl(CXXRecordDecl* decl)
+{
+	if(not decl->isCompleteDefinition())
+		return true;
+	for(CXXBaseSpecifier const& base : decl->bases())
+	{
+		TagDecl* tagDecl = base.getType()->getAsTagDecl();
+		if(tagDecl and tagDecl->getNameAsString() == "noncopyable")
+			continue;
+		if(base.getAccessSpecifier() != AS_public)
+			report(base.getLocStart(), "base-protection",
+			       "class " + decl->getNameAsString() + " use a private or protected base class");
+	}
+	if(DPrinter::isDClass(decl) and not isa<ClassTemplatePartialSpecializationDecl>(decl))
+	{
+		for(CXXConstructorDecl* ctor : decl->ctors())
+		{
+			if(ctor->isImplicit()
+			   and ctor->isCopyConstructor()
+			   and not ctor->isDeleted()
+			   and not DPrinter::isA(decl, "std::exception"))
+			{
+				report(decl->getLocation(), "copyable-class",
+				       "class " + decl->getNameAsString() + " is copy constructible");
+				break;
+			}
+		}
+	}
+	return true;
+}
+
+bool CPP2DAnalyzer::VisitCXXMethodDecl(CXXMethodDecl* decl)
+{
+	CXXRecordDecl* record = decl->getParent();
+	if(not DPrinter::isDClass(record))
+	{
+		if(decl->isPure())
+			report(decl->getLocation(), "virtual-in-struct",
+			       "struct " + record->getNameAsString() + " has abstract function");
+		else if(decl->isVirtual())
+			report(decl->getLocation(), "virtual-in-struct",
+			       "struct " + record->getNameAsString() + " has virtual function");
+	}
+	return true;
+}
+
+bool CPP2DAnalyzer::VisitCXXConstructorDecl(CXXConstructorDecl* decl)
+{
+	CXXRecordDecl* record = decl->getParent();
+	if(not DPrinter::isDClass(record)
+	   and decl->getBody() != nullptr
+	   and decl->isDefaultConstructor()
+	   and decl->getNumParams() == 0
+	   and decl->isExplicit()
+	   and not decl->isDefaulted())
+		report(decl->getLocation(), "struct-default-ctor",
+		       "struct " + record->getNameAsString() + " has an explicit default ctor");
+	return true;
+}
+
+void CPP2DAnalyzer::report(SourceLocation loc, char const* kind, std::string const& message)
+{
+	SourceManager const& sm = context.getSourceManager();
+	PresumedLoc const ploc = loc.isValid() ? sm.getPresumedLoc(sm.getExpansionLoc(loc)) : PresumedLoc();
+	std::string line;
+	llvm::raw_string_ostream os(line);
+	if(ploc.isValid())
+		os << ploc.getFilename() << ':' << ploc.getLine() << ':' << ploc.getColumn();
+	else
+		os << modulename << ":0:0";
+	os << ": " << kind << ": " << message << '\n';
+	if(reported.insert(os.str()).second)
+		llvm::outs() << line;
+}
+
+size_t getTotalIssueCount()
+{
+	return totalIssueCount;
+}
+
+std::unique_ptr<ASTConsumer> createAnalyzerConsumer(
+  llvm::StringRef inFile,
+  CPP2DPPHandling* ppHandling)
+{
+	return std::make_unique<AnalyzerConsumer>(inFile, ppHandling);
+}
@@ -0,0 +1,78 @@
+//
+// Copyright (c) 2016 Loïc HAMOT
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <memory>
+#include <set>
+#include <string>
+
+#pragma warning(push, 0)
+#include <clang/AST/RecursiveASTVisitor.h>
+#pragma warning(pop)
+
+class CPP2DPPHandling;
+class MatchContainer;
+
+namespace clang
+{
+class ASTConsumer;
+}
+
+//! @brief Find the constructs of the module which cpp2d can't convert, without printing the D code
+//!
+//! Check the same things as the DPrinter. Each construct is reported once on llvm::outs() :
+//!   <file>:<line>:<column>: <kind>: <message>
+//! Kinds are unhandled-decl, unhandled-stmt, unhandled-type (no printer for this node),
+//! virtual-in-struct, macro-stmt-no-init, base-protection, copyable-class, struct-default-ctor.
+class CPP2DAnalyzer : public clang::RecursiveASTVisitor<CPP2DAnalyzer>
+{
+	typedef clang::RecursiveASTVisitor<CPP2DAnalyzer> Base;
+
+public:
+	CPP2DAnalyzer(clang::ASTContext& context, MatchContainer& receiver, std::string modulename);
+
+	//! Analyze the declarations of the module (matchers have to be already registered)
+	void analyze();
+
+	//! Count of constructs reported
+	size_t getIssueCount() const
+	{
+		return reported.size();
+	}
+
+	// Nodes with a custom printer are supported, as all their children
+	bool TraverseDecl(clang::Decl* decl);
+	bool TraverseStmt(clang::Stmt* stmt);
+	bool TraverseType(clang::QualType type);
+	bool TraverseTypeLoc(clang::TypeLoc typeLoc);
+
+	bool VisitDecl(clang::Decl* decl);
+	bool VisitStmt(clang::Stmt* stmt);
+	bool VisitType(clang::Type* type);
+	bool VisitFieldDecl(clang::FieldDecl* decl);
+	bool VisitCXXRecordDecl(clang::CXXRecordDecl* decl);
+	bool VisitCXXMethodDecl(clang::CXXMethodDecl* decl);
+	bool VisitCXXConstructorDecl(clang::CXXConstructorDecl* decl);
+
+private:
+	//! Print the construct, if not already reported
+	void report(clang::SourceLocation loc, char const* kind, std::string const& message);
+
+	clang::ASTContext& context;
+	MatchContainer& receiver;
+	std::string modulename;
+	std::set<std::string> reported; //!< Reported lines. (Macros expand many times at same place)
+	clang::SourceLocation currentLoc; //!< Location of the last Decl or Stmt (Type have no location)
+};
+
+//! Create a consumer which run the matchers and the CPP2DAnalyzer on the module
+std::unique_ptr<clang::ASTConsumer> createAnalyzerConsumer(
+  llvm::StringRef inFile,
+  CPP2DPPHandling* ppHandling);
+
+//! Count of constructs reported by all the analyzers run (used for the exit code of --analyze)
+size_t getTotalIssueCount();
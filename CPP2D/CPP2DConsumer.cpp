@@ -7,25 +7,26 @@
 
 #include "CPP2DConsumer.h"
 #include "CPP2DPPHandling.h"
+#include "Options.h"
+#include "SymbolIndex.h"
 
 #include <fstream>
 #include <sstream>
 
 #pragma warning(push, 0)
-#include <clang/Frontend/CompilerInstance.h>
-#include <clang/Lex/Preprocessor.h>
+#include <llvm/Support/CommandLine.h>
 #include <llvm/Support/Path.h>
 #pragma warning(pop)
 
+extern llvm::cl::opt<bool> Incremental;
+extern llvm::cl::opt<unsigned> PrintJobs;
+
 CPP2DConsumer::CPP2DConsumer(
-  clang::CompilerInstance& compiler,
+  clang::ASTContext& context,
   llvm::StringRef inFile
 )
-	: compiler(compiler)
-	, finder(receiver.getMatcher())
-	, finderConsumer(finder.newASTConsumer())
-	, inFile(inFile.str())
-	, visitor(&compiler.getASTContext(), receiver, inFile)
+	: inFile(inFile.str())
+	, visitor(&context, receiver, inFile)
 {
 }
 
@@ -33,13 +34,29 @@ void CPP2DConsumer::HandleTranslationUnit(clang::ASTContext& context)
 {
 	//Find_Includes
 	CPP2DPPHandling& ppcallback = *ppcallbackPtr;
-	auto& incs = ppcallback.getIncludes();
+	printDModule(context,
+	             ppcallback.getIncludes(),
+	             ppcallback.getIncludedModules(),
+	             ppcallback.getInsertedBeforeDecls());
+}
 
-	finderConsumer->HandleTranslationUnit(context);
-	visitor.setIncludes(incs);
+void CPP2DConsumer::printDModule(
+  clang::ASTContext& context,
+  std::set<std::string> const& includes,
+  std::unordered_map<clang::FileEntry const*, std::string> const& includedModules,
+  std::set<std::string> const& insertedBeforeDecls)
+{
+	std::string modulename = llvm::sys::path::stem(inFile).str();
+	if(Options::getInstance().valueClasses or SymbolIndex::getInstance().isLoaded())
+		SymbolIndex::getInstance().collectTranslationUnit(context);
+	receiver.registerMatchers(finder, includes);
+	receiver.matchModuleDecls(finder, context, modulename);
+	visitor.setIncludes(includedModules);
+	if(Incremental)
+		visitor.setDeclCacheFile(modulename + ".dcache");
+	visitor.setPrintJobs(PrintJobs);
 	visitor.TraverseTranslationUnitDecl(context.getTranslationUnitDecl());
 
-	std::string modulename = llvm::sys::path::stem(inFile).str();
 	std::ofstream file(modulename + ".d");
 	std::string new_modulename;
 	std::replace_copy(std::begin(modulename), std::end(modulename),
@@ -54,7 +71,7 @@ void CPP2DConsumer::HandleTranslationUnit(clang::ASTContext& context)
 		file << std::endl;
 	}
 	file << "\n\n";
-	for(auto const& code : ppcallback.getInsertedBeforeDecls())
+	for(auto const& code : insertedBeforeDecls)
 		file << code << '\n';
 	file << visitor.getDCode();
 }
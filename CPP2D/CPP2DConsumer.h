@@ -15,9 +15,12 @@
 #include "MatchContainer.h"
 #include "DPrinter.h"
 
+#include <set>
+#include <unordered_map>
+
 namespace clang
 {
-class CompilerInstance;
+class FileEntry;
 }
 
 class CPP2DPPHandling;
@@ -27,23 +30,31 @@ class CPP2DConsumer : public clang::ASTConsumer
 {
 public:
 	explicit CPP2DConsumer(
-	  clang::CompilerInstance& compiler,
+	  clang::ASTContext& context,
 	  llvm::StringRef inFile
 	);
 
-	//! Print imports, mixins, and finaly call the DPrinter on the translationUnit
+	//! Call printDModule with the data gathered by the CPP2DPPHandling
 	void HandleTranslationUnit(clang::ASTContext& context) override;
 
+	//! Print imports, mixins, and finaly call the DPrinter on the translationUnit
+	//! @param includes Spelling of the includes of the translation unit
+	//! @param includedModules The **D** module of each included file
+	//! @param insertedBeforeDecls Macros to add in the D code
+	void printDModule(
+	  clang::ASTContext& context,
+	  std::set<std::string> const& includes,
+	  std::unordered_map<clang::FileEntry const*, std::string> const& includedModules,
+	  std::set<std::string> const& insertedBeforeDecls);
+
 	void setPPCallBack(CPP2DPPHandling* cb)
 	{
 		ppcallbackPtr = cb;
 	}
 
 private:
-	clang::CompilerInstance& compiler;
 	MatchContainer receiver;
 	clang::ast_matchers::MatchFinder finder;
-	std::unique_ptr<clang::ASTConsumer> finderConsumer;
 	std::string inFile;
 	DPrinter visitor;
 	CPP2DPPHandling* ppcallbackPtr = nullptr;
@@ -8,23 +8,34 @@
 #include "CPP2DFrontendAction.h"
 
 #include <memory>
+#include <ciso646>
 
 #pragma warning(push, 0)
 #include <clang/Frontend/CompilerInstance.h>
 #include <clang/Lex/Preprocessor.h>
+#include <llvm/Support/CommandLine.h>
 #pragma warning(pop)
 
+#include "CPP2DAnalyzer.h"
+#include "CPP2DASTFile.h"
 #include "CPP2DConsumer.h"
 #include "CPP2DPPHandling.h"
 
 using namespace clang;
 
+extern llvm::cl::opt<bool> EmitAST;
+extern llvm::cl::opt<bool> Analyze;
+
 std::unique_ptr<clang::ASTConsumer> CPP2DFrontendAction::CreateASTConsumer(
   clang::CompilerInstance& Compiler,
   llvm::StringRef InFile
 )
 {
-	auto consumer = std::make_unique<CPP2DConsumer>(Compiler, InFile);
+	if(EmitAST)
+		return createASTFileWriter(Compiler, InFile, ppHandlingPtr);
+	if(Analyze)
+		return createAnalyzerConsumer(InFile, ppHandlingPtr);
+	auto consumer = std::make_unique<CPP2DConsumer>(Compiler.getASTContext(), InFile);
 	consumer->setPPCallBack(ppHandlingPtr);
 	return std::move(consumer);
 }
@@ -38,3 +49,14 @@ bool CPP2DFrontendAction::BeginSourceFileAction(CompilerInstance& ci)
 	return true;
 }
 
+
+void CPP2DFrontendAction::EndSourceFileAction()
+{
+	if(includeGraph == nullptr or ppHandlingPtr == nullptr)
+		return;
+	// Paths are relative to the directory of the compile command, which is the current one
+	std::set<std::string>& includedFiles = (*includeGraph)[tooling::getAbsolutePath(getCurrentFile())];
+	includedFiles.clear();
+	for(auto const& file_n_module : ppHandlingPtr->getIncludedModules())
+		includedFiles.insert(tooling::getAbsolutePath(file_n_module.first->getName()));
+}
@@ -6,10 +6,14 @@
 //
 #pragma once
 
+#include <map>
 #include <memory>
+#include <set>
+#include <string>
 
 #pragma warning(push, 0)
 #include "clang/Frontend/FrontendActions.h"
+#include "clang/Tooling/Tooling.h"
 #pragma warning(pop)
 
 namespace clang
@@ -19,11 +23,20 @@ class CompilerInstance;
 
 class CPP2DPPHandling;
 
+//! Files included (recursively) by each translation unit. [source file] -> included files
+typedef std::map<std::string, std::set<std::string>> IncludeGraph;
+
 //! Implement clang::ASTFrontendAction to create the CPP2DConsumer
 class CPP2DFrontendAction : public clang::ASTFrontendAction
 {
 public:
-	//! Create the CPP2DConsumer
+	//! @param includeGraph If not null, filled with the files included by the translation unit
+	explicit CPP2DFrontendAction(IncludeGraph* includeGraph = nullptr)
+		: includeGraph(includeGraph)
+	{
+	}
+
+	//! Create the CPP2DConsumer, the AST file writer if --emit-ast is set, or the analyzer if --analyze
 	std::unique_ptr<clang::ASTConsumer> CreateASTConsumer(
 	  clang::CompilerInstance& Compiler,
 	  llvm::StringRef InFile
@@ -32,6 +45,28 @@ public:
 	//! Add the CPP2DPPHandling (PPCallbacks) to the Preprocessor
 	bool BeginSourceFileAction(clang::CompilerInstance& ci) override;
 
+	//! Fill the includeGraph
+	void EndSourceFileAction() override;
+
 private:
 	CPP2DPPHandling* ppHandlingPtr = nullptr;
+	IncludeGraph* includeGraph = nullptr;
+};
+
+//! Create the CPP2DFrontendAction, all sharing the same IncludeGraph
+class CPP2DFrontendActionFactory : public clang::tooling::FrontendActionFactory
+{
+public:
+	explicit CPP2DFrontendActionFactory(IncludeGraph* includeGraph = nullptr)
+		: includeGraph(includeGraph)
+	{
+	}
+
+	clang::FrontendAction* create() override
+	{
+		return new CPP2DFrontendAction(includeGraph);
+	}
+
+private:
+	IncludeGraph* includeGraph = nullptr;
 };
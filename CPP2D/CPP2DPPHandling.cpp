@@ -17,6 +17,8 @@
 #pragma warning(pop)
 
 #include <sstream>
+#include <algorithm>
+#include <map>
 #include "CPP2DTools.h"
 
 using namespace clang;
@@ -25,6 +27,50 @@ using namespace llvm;
 extern cl::list<std::string> MacroAsExpr;
 extern cl::list<std::string> MacroAsStmt;
 
+namespace
+{
+static std::string const MemFileSuffix = "_MemFileSuffix";
+
+//! A transformed macro definition, shared by all translation units of the run
+struct SharedMacro
+{
+	std::string name;       //!< Name of the transformed macro
+	std::string sharedName; //!< Name of the same macro, defined once per translation unit
+};
+//! [definition] -> SharedMacro
+std::map<std::string, SharedMacro> sharedMacros;
+
+//! Replace the name of a macro definition made by TransformMacroExpr or TransformMacroStmt
+std::string renameMacro(std::string const& definition,
+                        std::string const& name,
+                        std::string const& newName)
+{
+	std::string const define = "\n#define ";
+	assert(definition.compare(0, define.size() + name.size(), define + name) == 0);
+	return define + newName + definition.substr(define.size() + name.size());
+}
+}
+
+//! Get the **D** module name matching to an #include spelling. Like Foo/Bar-baz.h => foo.bar_baz
+std::string includeToModuleName(std::string include)
+{
+	static std::string const hExt = ".h";
+	static std::string const hppExt = ".hpp";
+	if(include.size() >= hExt.size() &&
+	   include.compare(include.size() - hExt.size(), hExt.size(), hExt) == 0)
+		include = include.substr(0, include.size() - hExt.size());
+	if(include.size() >= hppExt.size() &&
+	   include.compare(include.size() - hppExt.size(), hppExt.size(), hppExt) == 0)
+		include = include.substr(0, include.size() - hppExt.size());
+	std::transform(std::begin(include), std::end(include),
+	               std::begin(include),
+	[](char c) {return static_cast<char>(tolower(c)); });
+	std::replace(std::begin(include), std::end(include), '/', '.');
+	std::replace(std::begin(include), std::end(include), '\\', '.');
+	std::replace(std::begin(include), std::end(include), '-', '_');
+	return include;
+}
+
 CPP2DPPHandling::CPP2DPPHandling(clang::SourceManager& sourceManager_,
                                  Preprocessor& pp_,
                                  StringRef inFile_)
@@ -70,6 +116,12 @@ CPP2DPPHandling::CPP2DPPHandling(clang::SourceManager& sourceManager_,
 	             "int cpp2d_name(char const*);\n"
 	             "#define CPP2D_ADD2(A, B) A##B\n"
 	             "#define CPP2D_ADD(A, B) CPP2D_ADD2(A, B)\n";
+	// Macros transformed in the previous translation units are lexed once, with the predefines
+	for(auto const& definition_n_macro : sharedMacros)
+	{
+		SharedMacro const& macro = definition_n_macro.second;
+		predefines += renameMacro(definition_n_macro.first, macro.name, macro.sharedName) + "\n";
+	}
 	pp_.setPredefines(predefines);
 }
 
@@ -79,13 +131,20 @@ void CPP2DPPHandling::InclusionDirective(
   StringRef file_name,
   bool,					//is_angled,
   CharSourceRange,		//filename_range,
-  const FileEntry*,		//file,
+  const FileEntry* file,
   StringRef,			//search_path,
   StringRef,			//relative_path,
   const clang::Module*			//imported
 )
 {
 	includes_in_file.insert(file_name);
+	if(file == nullptr)
+		return;
+	std::string module = includeToModuleName(file_name);
+	auto const iter_inserted = included_modules.emplace(file, module);
+	// If the file is included with many spellings, keep always the same
+	if(iter_inserted.second == false && module < iter_inserted.first->second)
+		iter_inserted.first->second = std::move(module);
 }
 
 //! Print arguments of the macro MI into a std::stringstream, for a normal macro declaration
@@ -238,18 +297,35 @@ std::string make_d_macro(MacroInfo const* MI, std::string const& name)
 	return d_templ_str;
 }
 
-namespace
-{
-static std::string const MemFileSuffix = "_MemFileSuffix";
-}
-
 void CPP2DPPHandling::inject_macro(
   MacroDirective const* MD,
   std::string const& name,
   std::string const& new_macro)
 {
-	// TODO : Find a better way if it exists
-	auto iter_inserted = new_macros.insert(new_macro);
+	char const* filename = CPP2DTools::getFile(sourceManager, MD->getLocation());
+	if(CPP2DTools::checkFilename(modulename, filename))
+		add_before_decl.insert(make_d_macro(MD->getMacroInfo(), name));
+
+	// If the same definition was already lexed (in the predefines or in a previous injection),
+	//  its clang::MacroInfo is reused, without creating a new file.
+	auto shared = sharedMacros.find(new_macro);
+	if(shared != sharedMacros.end())
+	{
+		if(clang::MacroInfo* sharedMI = pp.getMacroInfo(pp.getIdentifierInfo(shared->second.sharedName)))
+		{
+			pp.appendDefMacroDirective(pp.getIdentifierInfo(name), sharedMI, MD->getLocation());
+			return;
+		}
+	}
+	else
+	{
+		std::string const sharedName = "CPP2D_SHARED_MACRO_" + std::to_string(sharedMacros.size());
+		shared = sharedMacros.emplace(new_macro, SharedMacro{ name, sharedName }).first;
+	}
+
+	// Define the macro, and the shared one to reuse it
+	auto iter_inserted = new_macros.insert(
+	                       new_macro + renameMacro(new_macro, name, shared->second.sharedName) + "\n");
 	std::unique_ptr<MemoryBuffer> membuf =
 	  MemoryBuffer::getMemBuffer(*iter_inserted.first, "<" + name + MemFileSuffix + ">");
 	assert(membuf);
@@ -257,10 +333,6 @@ void CPP2DPPHandling::inject_macro(
 	                  std::move(membuf), clang::SrcMgr::C_User, 0, 0, MD->getLocation());
 
 	pp.EnterSourceFile(fileID, pp.GetCurDirLookup(), MD->getMacroInfo()->getDefinitionEndLoc());
-
-	char const* filename = CPP2DTools::getFile(sourceManager, MD->getLocation());
-	if(CPP2DTools::checkFilename(modulename, filename))
-		add_before_decl.insert(make_d_macro(MD->getMacroInfo(), name));
 }
 
 void CPP2DPPHandling::TransformMacroExpr(
@@ -351,6 +423,11 @@ std::set<std::string> const& CPP2DPPHandling::getIncludes() const
 	return includes_in_file;
 }
 
+std::unordered_map<FileEntry const*, std::string> const& CPP2DPPHandling::getIncludedModules() const
+{
+	return included_modules;
+}
+
 std::set<std::string> const& CPP2DPPHandling::getInsertedBeforeDecls() const
 {
 	return add_before_decl;
@@ -12,6 +12,7 @@
 #pragma warning(pop)
 
 #include <set>
+#include <unordered_map>
 
 namespace clang
 {
@@ -26,14 +27,14 @@ public:
 	                clang::Preprocessor& pp,
 	                llvm::StringRef inFile);
 
-	//! Fill the list of included files (includes_in_file)
+	//! Fill the list of included files (includes_in_file) and their **D** module (included_modules)
 	void InclusionDirective(
 	  clang::SourceLocation,		//hash_loc,
 	  const clang::Token&,			//include_token,
 	  llvm::StringRef file_name,
 	  bool,							//is_angled,
 	  clang::CharSourceRange,		//filename_range,
-	  const clang::FileEntry*,		//file,
+	  const clang::FileEntry* file,
 	  llvm::StringRef,				//search_path,
 	  llvm::StringRef,				//relative_path,
 	  const clang::Module*			//imported
@@ -44,6 +45,8 @@ public:
 
 	//! Get include list
 	std::set<std::string> const& getIncludes() const;
+	//! Get the **D** module name of each included file
+	std::unordered_map<clang::FileEntry const*, std::string> const& getIncludedModules() const;
 	//! Get macros to add in the D code
 	std::set<std::string> const& getInsertedBeforeDecls() const;
 
@@ -80,6 +83,7 @@ private:
 	std::map<std::string, MacroInfo> macro_stmt;
 
 	std::set<std::string> includes_in_file;
+	std::unordered_map<clang::FileEntry const*, std::string> included_modules;
 	std::set<std::string> add_before_decl;
 
 	std::string predefines;
@@ -0,0 +1,167 @@
+//
+// Copyright (c) 2016 Loïc HAMOT
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "CPP2DParallel.h"
+#include "CPP2DTools.h"
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <sstream>
+#include <ciso646>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifndef _WIN32
+
+namespace
+{
+//! Write all the buffer, even if the pipe is full
+bool writeAll(int fd, std::string const& data)
+{
+	char const* ptr = data.data();
+	size_t left = data.size();
+	while(left != 0)
+	{
+		ssize_t const written = write(fd, ptr, left);
+		if(written <= 0)
+			return false;
+		ptr += written;
+		left -= static_cast<size_t>(written);
+	}
+	return true;
+}
+
+//! Take tasks until there is no more, and send their results : index, then result
+void runWorker(std::atomic<size_t>& nextTask,
+               size_t count,
+               std::function<std::string(size_t)> const& task,
+               int fd)
+{
+	for(size_t index = nextTask++; index < count; index = nextTask++)
+	{
+		std::stringstream message;
+		message << index << ' ';
+		CPP2DTools::writeString(message, task(index));
+		if(not writeAll(fd, message.str()))
+			_exit(1);
+	}
+	close(fd);
+	_exit(0); // Nothing to destroy nor to flush : the parent own the state
+}
+}
+
+std::vector<std::string> runInProcesses(
+  size_t count,
+  unsigned jobs,
+  std::function<std::string(size_t)> const& task)
+{
+	std::vector<std::string> results;
+	void* shared = mmap(nullptr, sizeof(std::atomic<size_t>),
+	                    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if(shared == MAP_FAILED)
+		return results;
+	auto* nextTask = new(shared) std::atomic<size_t>(0);
+
+	struct Worker
+	{
+		pid_t pid;
+		int fd;
+		std::string received;
+	};
+	std::vector<Worker> workers;
+	for(unsigned i = 0; i < jobs and i < count; ++i)
+	{
+		int fds[2];
+		if(pipe(fds) != 0)
+			break;
+		pid_t const pid = fork();
+		if(pid == 0)
+		{
+			close(fds[0]);
+			for(Worker const& worker : workers)
+				close(worker.fd);
+			runWorker(*nextTask, count, task, fds[1]);
+		}
+		close(fds[1]);
+		if(pid < 0)
+		{
+			close(fds[0]);
+			break;
+		}
+		workers.push_back(Worker{pid, fds[0], std::string()});
+	}
+
+	// Read all pipes at the same time, else a worker could block on a full pipe
+	std::vector<pollfd> pollFds;
+	for(Worker const& worker : workers)
+		pollFds.push_back(pollfd{worker.fd, POLLIN, 0});
+	size_t openCount = pollFds.size();
+	while(openCount != 0)
+	{
+		if(poll(pollFds.data(), pollFds.size(), -1) < 0)
+			break;
+		for(size_t i = 0; i != pollFds.size(); ++i)
+		{
+			if(pollFds[i].fd < 0 or pollFds[i].revents == 0)
+				continue;
+			char buffer[65536];
+			ssize_t const size = read(pollFds[i].fd, buffer, sizeof(buffer));
+			if(size > 0)
+				workers[i].received.append(buffer, static_cast<size_t>(size));
+			else
+			{
+				close(pollFds[i].fd);
+				pollFds[i].fd = -1;
+				--openCount;
+			}
+		}
+	}
+
+	bool success = not workers.empty();
+	for(Worker const& worker : workers)
+	{
+		int status = 0;
+		if(waitpid(worker.pid, &status, 0) < 0 or not WIFEXITED(status) or WEXITSTATUS(status) != 0)
+			success = false;
+	}
+	munmap(shared, sizeof(std::atomic<size_t>));
+
+	results.resize(count);
+	std::vector<bool> received(count, false);
+	for(Worker const& worker : workers)
+	{
+		std::istringstream message(worker.received);
+		size_t index = 0;
+		while(message >> index)
+		{
+			if(index >= count or not message.ignore() or not CPP2DTools::readString(message, results[index]))
+				return std::vector<std::string>();
+			received[index] = true;
+		}
+	}
+	if(not success or std::find(received.begin(), received.end(), false) != received.end())
+		return std::vector<std::string>();
+	return results;
+}
+
+#else
+
+std::vector<std::string> runInProcesses(
+  size_t,
+  unsigned,
+  std::function<std::string(size_t)> const&)
+{
+	return std::vector<std::string>();
+}
+
+#endif
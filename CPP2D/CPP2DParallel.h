@@ -0,0 +1,23 @@
+//
+// Copyright (c) 2016 Loïc HAMOT
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+//! @brief Call task(i) for i in [0, count), in jobs forked processes
+//!
+//! Processes are forked after parsing, so they share the AST and don't need any lock.
+//! Each process take the next index from a shared counter, so an idle process take the
+//! remaining work of the others, whatever the cost of each task.
+//! @return The results of the tasks by index. Empty if the processes can't be created.
+//! @remark Not supported under Windows (always return an empty vector)
+std::vector<std::string> runInProcesses(
+  size_t count,
+  unsigned jobs,
+  std::function<std::string(size_t)> const& task);
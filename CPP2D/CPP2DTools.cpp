@@ -11,6 +11,10 @@
 #include <clang/AST/ASTContext.h>
 #pragma warning(pop)
 
+#include <istream>
+#include <ostream>
+#include <ciso646>
+
 using namespace llvm;
 using namespace clang;
 
@@ -18,6 +22,8 @@ using namespace clang;
 namespace CPP2DTools
 {
 
+extern char const* const Version = "cpp2d 1, built " __DATE__ " " __TIME__;
+
 const char* getFile(clang::SourceManager const& sourceManager, clang::SourceLocation const& sl)
 {
 	if(sl.isValid() == false)
@@ -41,6 +47,14 @@ const char* getFile(clang::SourceManager const& sourceManager, Decl const* d)
 	return getFile(sourceManager, d->getLocation());
 }
 
+clang::FileEntry const* getFileEntry(clang::SourceManager const& sourceManager, Decl const* d)
+{
+	SourceLocation const sl = d->getLocation();
+	if(sl.isValid() == false)
+		return nullptr;
+	return sourceManager.getFileEntryForID(sourceManager.getFileID(sourceManager.getExpansionLoc(sl)));
+}
+
 bool checkFilename(std::string const& modulename, char const* filepath_str)
 {
 	if(filepath_str == nullptr)
@@ -80,4 +94,21 @@ std::string replaceString(std::string subject,
 	return subject;
 }
 
+void writeString(std::ostream& os, std::string const& str)
+{
+	os << str.size() << ':' << str << '\n';
+}
+
+bool readString(std::istream& is, std::string& str)
+{
+	size_t size = 0;
+	char sep = 0;
+	if(not(is >> size) or not is.get(sep) or sep != ':')
+		return false;
+	str.resize(size);
+	if(size != 0 and not is.read(&str[0], static_cast<std::streamsize>(size)))
+		return false;
+	return static_cast<bool>(is.get(sep));
+}
+
 } //CPP2DTools
\ No newline at end of file
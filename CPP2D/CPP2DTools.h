@@ -6,6 +6,7 @@
 //
 #pragma once
 #include <string>
+#include <iosfwd>
 
 namespace clang
 {
@@ -13,16 +14,22 @@ class ASTContext;
 class Stmt;
 class Decl;
 class SourceLocation;
+class FileEntry;
 }
 
 namespace CPP2DTools
 {
+//! Version of cpp2d, and date of its build. The caches of an other version are not used.
+extern char const* const Version;
+
 //! Get the name of the file pointed by sl
 const char* getFile(clang::SourceManager const& sourceManager, clang::SourceLocation const& sl);
 //! Get the name of the file pointed by s
 const char* getFile(clang::SourceManager const& sourceManager, clang::Stmt const* s);
 //! Get the name of the file pointed by d
 const char* getFile(clang::SourceManager const& sourceManager, clang::Decl const* d);
+//! Get the file pointed by d, or nullptr if it is not in a file
+clang::FileEntry const* getFileEntry(clang::SourceManager const& sourceManager, clang::Decl const* d);
 //! @return true if the file is the header of the module (the matching header of the cpp)
 bool checkFilename(std::string const& modulename, char const* filepath_str);
 //! @return true if the file of d is in the header of the module
@@ -36,4 +43,11 @@ std::string replaceString(std::string subject,
                           const std::string& search,
                           const std::string& replace);
 
+//! Write a string which can contain new lines, prefixed by its size
+void writeString(std::ostream& os, std::string const& str);
+
+//! Read a string written by writeString
+//! @return false on failure
+bool readString(std::istream& is, std::string& str);
+
 }
\ No newline at end of file
@@ -0,0 +1,182 @@
+//
+// Copyright (c) 2016 Loïc HAMOT
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "CPP2DWatch.h"
+
+#include <map>
+#include <set>
+#include <ciso646>
+
+#pragma warning(push, 0)
+#include <clang/Tooling/CompilationDatabase.h>
+#include <clang/Tooling/Tooling.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+#pragma warning(pop)
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+using namespace clang::tooling;
+
+#ifdef __linux__
+
+namespace
+{
+//! Time without change before reconverting (Editors often write many times per save)
+int const DebounceMilliseconds = 200;
+
+//! Get the canonical path of a file, to compare paths from inotify and from the includes
+std::string canonicalPath(std::string const& path)
+{
+	llvm::SmallString<256> result;
+	if(llvm::sys::fs::real_path(path, result))
+	{
+		result = path;
+		llvm::sys::fs::make_absolute(result);
+		llvm::sys::path::remove_dots(result, true);
+	}
+	return result.str().str();
+}
+
+//! Watch the directories of the sources and included files, and read their events
+class DirectoryWatcher
+{
+public:
+	DirectoryWatcher()
+		: fd(inotify_init1(IN_CLOEXEC))
+	{
+	}
+
+	~DirectoryWatcher()
+	{
+		if(fd >= 0)
+			close(fd);
+	}
+
+	bool isValid() const
+	{
+		return fd >= 0;
+	}
+
+	//! Watch the directory of this file (the file itself would be lost if replaced by rename)
+	void watchFile(std::string const& file)
+	{
+		std::string const dir = llvm::sys::path::parent_path(file).str();
+		if(dir.empty() or watchedDirs.count(dir))
+			return;
+		int const wd = inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+		if(wd < 0)
+		{
+			llvm::errs() << "Can't watch the directory " << dir << "\n";
+			return;
+		}
+		watchedDirs.insert(dir);
+		wdToDir[wd] = dir;
+	}
+
+	//! Wait for a change, then until no change append during DebounceMilliseconds
+	//! @return The paths of all changed files
+	std::set<std::string> waitChanges()
+	{
+		std::set<std::string> changed;
+		int timeout = -1; //Wait indefinitely for the first event
+		while(true)
+		{
+			pollfd pfd = {fd, POLLIN, 0};
+			int const ready = poll(&pfd, 1, timeout);
+			if(ready < 0)
+				return changed;
+			if(ready == 0)
+				break;
+			alignas(inotify_event) char buffer[4096];
+			ssize_t const size = read(fd, buffer, sizeof(buffer));
+			if(size <= 0)
+				return changed;
+			for(char const* ptr = buffer; ptr < buffer + size;)
+			{
+				auto* event = reinterpret_cast<inotify_event const*>(ptr);
+				auto iter = wdToDir.find(event->wd);
+				if(event->len != 0 and iter != wdToDir.end())
+					changed.insert(iter->second + "/" + event->name);
+				ptr += sizeof(inotify_event) + event->len;
+			}
+			timeout = DebounceMilliseconds;
+		}
+		return changed;
+	}
+
+private:
+	int fd;
+	std::set<std::string> watchedDirs;
+	std::map<int, std::string> wdToDir;
+};
+}
+
+int watchSources(CompilationDatabase& compilations,
+                 std::vector<std::string> const& sources,
+                 IncludeGraph& includeGraph)
+{
+	DirectoryWatcher watcher;
+	if(not watcher.isValid())
+	{
+		llvm::errs() << "Can't initialize inotify\n";
+		return 1;
+	}
+
+	// The registry of custom printers and the compilation database stay loaded between
+	//  the conversions. Only the changed sources are parsed again.
+	CPP2DFrontendActionFactory factory(&includeGraph);
+	while(true)
+	{
+		// [watched file] -> sources to reconvert
+		std::map<std::string, std::set<std::string>> dependentSources;
+		for(std::string const& source : sources)
+			dependentSources[canonicalPath(source)].insert(getAbsolutePath(source));
+		for(auto const& source_n_includes : includeGraph)
+		{
+			dependentSources[canonicalPath(source_n_includes.first)].insert(source_n_includes.first);
+			for(std::string const& include : source_n_includes.second)
+				dependentSources[canonicalPath(include)].insert(source_n_includes.first);
+		}
+		for(auto const& file_n_sources : dependentSources)
+			watcher.watchFile(file_n_sources.first);
+
+		std::set<std::string> toConvert;
+		for(std::string const& changedFile : watcher.waitChanges())
+		{
+			auto iter = dependentSources.find(canonicalPath(changedFile));
+			if(iter != dependentSources.end())
+				toConvert.insert(iter->second.begin(), iter->second.end());
+		}
+		if(toConvert.empty())
+			continue;
+
+		for(std::string const& source : toConvert)
+			llvm::outs() << "Converting " << source << "\n";
+		llvm::outs().flush();
+		ClangTool tool(compilations, std::vector<std::string>(toConvert.begin(), toConvert.end()));
+		tool.run(&factory);
+	}
+}
+
+#else
+
+int watchSources(CompilationDatabase&,
+                 std::vector<std::string> const&,
+                 IncludeGraph&)
+{
+	llvm::errs() << "--watch is only supported under Linux\n";
+	return 1;
+}
+
+#endif
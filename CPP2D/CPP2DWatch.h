@@ -0,0 +1,31 @@
+//
+// Copyright (c) 2016 Loïc HAMOT
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "CPP2DFrontendAction.h"
+
+namespace clang
+{
+namespace tooling
+{
+class CompilationDatabase;
+}
+}
+
+//! @brief Wait for changes in sources and included files, and reconvert the dependent sources
+//!
+//! Bursts of changes are merged, so a source is reconverted only once per burst.
+//! Never return, except on error.
+//! @remark Only supported under Linux (inotify)
+int watchSources(
+  clang::tooling::CompilationDatabase& compilations,
+  std::vector<std::string> const& sources,
+  IncludeGraph& includeGraph //!< Filled by the first conversion of sources
+);
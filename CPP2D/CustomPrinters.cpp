@@ -7,18 +7,42 @@
 
 #include "CustomPrinters.h"
 
+#include <algorithm>
+
 CustomPrinters& CustomPrinters::getInstance()
 {
 	static CustomPrinters instance;
 	return instance;
 }
 
-void CustomPrinters::registerCustomPrinters(CustomPrinterRegistrer registrer)
+void CustomPrinters::registerCustomPrinters(CustomPrinterRegistrer registrer,
+                                            std::vector<std::string> const& includes)
+{
+	registrers.emplace(registrer, includes);
+}
+
+//! Is include in includes. If include end by '/', is an include in this directory.
+bool isIncluded(std::set<std::string> const& includes, std::string const& include)
 {
-	registrers.insert(registrer);
+	if(include.empty() || include.back() != '/')
+		return includes.count(include) != 0;
+	auto const iter = includes.lower_bound(include);
+	return iter != includes.end() && iter->compare(0, include.size(), include) == 0;
 }
 
-std::set<CustomPrinters::CustomPrinterRegistrer> const& CustomPrinters::getRegisterers() const
+std::vector<CustomPrinters::CustomPrinterRegistrer>
+CustomPrinters::getRegisterers(std::set<std::string> const& includes) const
 {
-	return registrers;
+	std::vector<CustomPrinterRegistrer> result;
+	for(auto const& registrer_n_includes : registrers)
+	{
+		auto const& activators = registrer_n_includes.second;
+		if(activators.empty() ||
+		   std::any_of(std::begin(activators), std::end(activators), [&](std::string const & include)
+		{
+			return isIncluded(includes, include);
+		}))
+			result.push_back(registrer_n_includes.first);
+	}
+	return result;
 }
@@ -7,6 +7,8 @@
 
 #include "MatchContainer.h"
 #include <set>
+#include <map>
+#include <vector>
 
 //! Singleton where all custom printers are registered
 class CustomPrinters
@@ -19,15 +21,26 @@ public:
 	  MatchContainer&,
 	  clang::ast_matchers::MatchFinder&);
 
-	//! Add a register fonction
-	void registerCustomPrinters(CustomPrinterRegistrer registrer);
+	//! @brief Add a register fonction
+	//! It will be called only if one of the includes is found in the <b>C++</b> source,
+	//! or always if includes is empty.
+	//! An include ending by '/' match all includes in this directory.
+	void registerCustomPrinters(
+	  CustomPrinterRegistrer registrer,
+	  std::vector<std::string> const& includes = std::vector<std::string>());
 
-	//! Get the liste of register functions
-	std::set<CustomPrinterRegistrer> const& getRegisterers() const;
+	//! Get the liste of register functions activated by the includes of the <b>C++</b> source
+	std::vector<CustomPrinterRegistrer> getRegisterers(std::set<std::string> const& includes) const;
 
 private:
-	std::set<CustomPrinterRegistrer> registrers;
+	//! Register functions, with the includes which activate them
+	std::map<CustomPrinterRegistrer, std::vector<std::string> > registrers;
 };
 
+//! Register FUNC_NAME for all C++ sources
 #define REG_CUSTOM_PRINTER(FUNC_NAME) \
-	namespace{auto reg = (CustomPrinters::getInstance().registerCustomPrinters(&FUNC_NAME), 0);}
+	namespace{auto reg_##FUNC_NAME = (CustomPrinters::getInstance().registerCustomPrinters(&FUNC_NAME), 0);}
+
+//! Register FUNC_NAME for the C++ sources which include one of the following headers
+#define REG_CUSTOM_PRINTER_FOR(FUNC_NAME, ...) \
+	namespace{auto reg_##FUNC_NAME = (CustomPrinters::getInstance().registerCustomPrinters(&FUNC_NAME, {__VA_ARGS__}), 0);}
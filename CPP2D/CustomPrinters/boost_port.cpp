@@ -38,11 +38,9 @@ void printFormatFuncOrOpCall(DPrinter& pr, Expr* leftOp)
 };
 
 
-//! @todo This function has to be split across all includes
-void boost_port(MatchContainer& mc, MatchFinder& finder)
+//! Port of BOOST_THROW_EXCEPTION
+void boost_exception_port(MatchContainer& mc, MatchFinder&)
 {
-	//**************************** boost **********************************************************
-
 	//BOOST_THROW_EXCEPTION
 	mc.globalFuncPrinter("throw_exception_(<|$)", [](DPrinter & pr, Stmt * s)
 	{
@@ -52,10 +50,22 @@ void boost_port(MatchContainer& mc, MatchFinder& finder)
 			pr.TraverseStmt(*memCall->arg_begin());
 		}
 	});
+}
+
+REG_CUSTOM_PRINTER_FOR(boost_exception_port, "boost/throw_exception.hpp", "boost/exception/");
 
+//! Port of boost::serialization
+void boost_serialization_port(MatchContainer& mc, MatchFinder& finder)
+{
 	//boost::serialisation
 	mc.rewriteType(finder, "boost::serialization::access", "int", "");
+}
+
+REG_CUSTOM_PRINTER_FOR(boost_serialization_port, "boost/serialization/");
 
+//! Port of boost::log
+void boost_log_port(MatchContainer& mc, MatchFinder& finder)
+{
 	finder.addMatcher(
 	  forStmt(
 	    hasLoopInit(declStmt(hasSingleDecl(varDecl(hasType(namedDecl(matchesName("record"))))))))
@@ -69,7 +79,13 @@ void boost_port(MatchContainer& mc, MatchFinder& finder)
 			pr.stream() << ';';
 		}
 	});
+}
+
+REG_CUSTOM_PRINTER_FOR(boost_log_port, "boost/log/");
 
+//! Port of boost::format
+void boost_format_port(MatchContainer& mc, MatchFinder& finder)
+{
 	//boost::format
 	Options::getInstance().types["class boost::basic_format<"].semantic = TypeOptions::Value;
 
@@ -95,8 +111,13 @@ void boost_port(MatchContainer& mc, MatchFinder& finder)
 		if(auto* memCall = dyn_cast<CallExpr>(s))
 			pr.TraverseStmt(memCall->getArg(0));
 	});
+}
 
+REG_CUSTOM_PRINTER_FOR(boost_format_port, "boost/format.hpp", "boost/format/");
 
+//! Port of boost::range
+void boost_range_port(MatchContainer& mc, MatchFinder& finder)
+{
 	// ****************************** boost::range ***********************************************
 	// transform
 	finder.addMatcher(cxxOperatorCallExpr(
@@ -128,4 +149,4 @@ void boost_port(MatchContainer& mc, MatchFinder& finder)
 	});
 }
 
-REG_CUSTOM_PRINTER(boost_port);
+REG_CUSTOM_PRINTER_FOR(boost_range_port, "boost/range/");
@@ -17,7 +17,8 @@
 using namespace clang;
 using namespace clang::ast_matchers;
 
-void c_stdlib_port(MatchContainer& mc, MatchFinder& finder)
+//! Port of <stdio.h>
+void c_stdio_port(MatchContainer& mc, MatchFinder&)
 {
 	// <stdio>
 	char const* stdioFuncs[] =
@@ -33,7 +34,13 @@ void c_stdlib_port(MatchContainer& mc, MatchFinder& finder)
 	};
 	for(char const* func : stdioFuncs)
 		mc.cFuncPrinter("stdio", func);
+}
+
+REG_CUSTOM_PRINTER_FOR(c_stdio_port, "stdio.h", "cstdio");
 
+//! Port of <string.h>
+void c_string_port(MatchContainer& mc, MatchFinder&)
+{
 	// <string>
 	char const* stringFuncs[] =
 	{
@@ -44,7 +51,13 @@ void c_stdlib_port(MatchContainer& mc, MatchFinder& finder)
 	};
 	for(char const* func : stringFuncs)
 		mc.cFuncPrinter("string", func);
+}
 
+REG_CUSTOM_PRINTER_FOR(c_string_port, "string.h", "cstring");
+
+//! Port of <stdlib.h>
+void c_stdlib_port(MatchContainer& mc, MatchFinder&)
+{
 	// <stdlib>
 	char const* stdlibFuncs[] =
 	{
@@ -56,7 +69,13 @@ void c_stdlib_port(MatchContainer& mc, MatchFinder& finder)
 	};
 	for (char const* func : stdlibFuncs)
 		mc.cFuncPrinter("stdlib", func);
+}
+
+REG_CUSTOM_PRINTER_FOR(c_stdlib_port, "stdlib.h", "cstdlib");
 
+//! Port of <math.h>
+void c_math_port(MatchContainer& mc, MatchFinder&)
+{
 	// <cmath>
 	char const* mathFuncs[] =
 	{
@@ -74,16 +93,28 @@ void c_stdlib_port(MatchContainer& mc, MatchFinder& finder)
 	};
 	for(char const* func : mathFuncs)
 		mc.cFuncPrinter("math", func);
+}
 
+REG_CUSTOM_PRINTER_FOR(c_math_port, "math.h", "cmath");
+
+//! Port of <time.h>
+void c_time_port(MatchContainer& mc, MatchFinder& finder)
+{
 	// <ctime>
 	mc.cFuncPrinter("time", "time");
 	mc.cFuncPrinter("time", "clock");
 	mc.rewriteType(finder, "clock_t", "core.stdc.time.clock_t", "core.stdc.time");
 	mc.rewriteType(finder, "std::clock_t", "core.stdc.time.clock_t", "core.stdc.time");
+}
+
+REG_CUSTOM_PRINTER_FOR(c_time_port, "time.h", "ctime");
 
+//! Port of <assert.h>
+void c_assert_port(MatchContainer& mc, MatchFinder&)
+{
 	//<assert>
 	mc.globalFuncPrinter("^(::std)?::_wassert$", [](DPrinter&, Stmt*) {});
 	mc.globalFuncPrinter("^(::)?__assert_fail$", [](DPrinter&, Stmt*) {});
 }
 
-REG_CUSTOM_PRINTER(c_stdlib_port);
+REG_CUSTOM_PRINTER_FOR(c_assert_port, "assert.h", "cassert");
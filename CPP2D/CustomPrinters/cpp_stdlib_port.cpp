@@ -22,8 +22,8 @@
 using namespace clang;
 using namespace clang::ast_matchers;
 
-//! @todo This function has to be split across all includes
-void cpp_stdlib_port(MatchContainer& mc, MatchFinder& finder)
+//! Port of <exception> and <stdexcept>
+void cpp_stdlib_exception_port(MatchContainer& mc, MatchFinder& finder)
 {
 	// ********************************* <exception> **********************************************
 	mc.rewriteType(finder, "std::exception", "Throwable", "");
@@ -45,7 +45,97 @@ void cpp_stdlib_port(MatchContainer& mc, MatchFinder& finder)
 			}
 		}
 	});
+}
+
+REG_CUSTOM_PRINTER_FOR(cpp_stdlib_exception_port, "exception", "stdexcept", "new", "typeinfo");
 
+namespace
+{
+//! @brief If expr call begin() or end() (maybe through a conversion), get the method name
+//! @param[out] container The object of the call
+std::string getIteratorMethodName(Expr* expr, Expr*& container)
+{
+	expr = expr->IgnoreImplicit();
+	if(auto* construct = dyn_cast<CXXConstructExpr>(expr)) // iterator to const_iterator
+	{
+		if(construct->getNumArgs() == 1)
+			expr = construct->getArg(0)->IgnoreImplicit();
+	}
+	if(auto* memCall = dyn_cast<CXXMemberCallExpr>(expr))
+	{
+		std::string const name = memCall->getMethodDecl()->getNameAsString();
+		if(name == "begin" || name == "end" || name == "cbegin" || name == "cend")
+		{
+			container = memCall->getImplicitObjectArgument();
+			return name[0] == 'c' ? name.substr(1) : name;
+		}
+	}
+	return std::string();
+}
+
+//! Print an iterator of a std::vector as an index : begin() => 0, end() => vec.length...
+void printVectorIndex(DPrinter& pr, Expr* pos)
+{
+	Expr* container = nullptr;
+	std::string const name = getIteratorMethodName(pos, container);
+	auto* opCall = dyn_cast<CXXOperatorCallExpr>(pos->IgnoreImplicit());
+	if(name == "begin")
+		pr.stream() << "0";
+	else if(name == "end")
+	{
+		pr.TraverseStmt(container);
+		pr.stream() << ".length";
+	}
+	else if(opCall && opCall->getNumArgs() == 2
+	        && (opCall->getOperator() == OO_Plus || opCall->getOperator() == OO_Minus))
+	{
+		printVectorIndex(pr, opCall->getArg(0));
+		pr.stream() << (opCall->getOperator() == OO_Plus ? " + " : " - ");
+		pr.TraverseStmt(opCall->getArg(1));
+	}
+	else
+		pr.TraverseStmt(pos);
+}
+
+//! True if this type is a std::map<K, V>::(const_)iterator, printed cpp_std.map.Range
+bool isStdMapIterator(QualType type)
+{
+	while(auto* typedefType = type->getAs<TypedefType>())
+	{
+		auto* tmpSpec = dyn_cast<ClassTemplateSpecializationDecl>(typedefType->getDecl()->getDeclContext());
+		if(tmpSpec && tmpSpec->isInStdNamespace() && tmpSpec->getName() == "map")
+			return true;
+		type = typedefType->desugar();
+	}
+	return false;
+}
+
+//! Print a method call as a call to the function func of cpp_std, with the object as first argument
+void printCppStdCall(DPrinter& pr, Stmt* s, char const* func)
+{
+	if(auto* memCall = dyn_cast<CXXMemberCallExpr>(s))
+	{
+		if(auto* memExpr = dyn_cast<MemberExpr>(memCall->getCallee()))
+		{
+			pr.stream() << "cpp_std." << func << '(';
+			pr.TraverseStmt(memExpr->isImplicitAccess() ? nullptr : memExpr->getBase());
+			for(Expr* arg : memCall->arguments())
+			{
+				if(isa<CXXDefaultArgExpr>(arg))
+					break;
+				pr.stream() << ", ";
+				pr.TraverseStmt(arg);
+			}
+			pr.stream() << ')';
+			pr.addExternInclude("cpp_std", std::string("cpp_std.") + func);
+		}
+	}
+}
+}
+
+//! Port of the containers (<vector>, <map>, <unordered_set>...)
+void cpp_stdlib_containers_port(MatchContainer& mc, MatchFinder& finder)
+{
 	//********************** Containers array and vector ******************************************
 	std::string const containers =
 	  "^::(boost|std)::(vector|array|set|map|multiset|multimap|unordered_set|unordered_map|"
@@ -85,6 +175,23 @@ void cpp_stdlib_port(MatchContainer& mc, MatchFinder& finder)
 		}
 	});
 
+	mc.tmplTypePrinter("^::std::map<.*>::(const_)?iterator$", [](DPrinter & printer, Decl * d)
+	{
+		if(auto* named = dyn_cast<NamedDecl>(d))
+		{
+			if(auto* tmpSpec = dyn_cast_or_null<ClassTemplateSpecializationDecl>(named->getDeclContext()))
+			{
+				printer.addExternInclude("cpp_std", "cpp_std.map");
+				printer.stream() << "cpp_std.map!(";
+				TemplateArgumentList const& tmpArgsSpec = tmpSpec->getTemplateInstantiationArgs();
+				printer.printTemplateArgument(tmpArgsSpec.get(0));
+				printer.stream() << ", ";
+				printer.printTemplateArgument(tmpArgsSpec.get(1));
+				printer.stream() << ").Range";
+			}
+		}
+	});
+
 	finder.addMatcher(callExpr(
 	                    anyOf(
 	                      callee(functionDecl(matchesName(containers + "\\<.*\\>::size$"))),
@@ -161,6 +268,93 @@ void cpp_stdlib_port(MatchContainer& mc, MatchFinder& finder)
 		});
 	}
 
+	// ********************************** std::vector ********************************************
+	// cpp_std.vector is a std.container.array.Array. The missing methods are functions in cpp_std.
+	// (Registered before the printers of all containers, which don't replace them)
+	mc.methodPrinter("std::vector", "emplace_back", [](DPrinter & pr, Stmt * s)
+	{
+		auto* memCall = dyn_cast<CXXMemberCallExpr>(s);
+		if(memCall == nullptr)
+			return;
+		// Emplace a copy : Just insert it
+		auto* vecSpec = dyn_cast<ClassTemplateSpecializationDecl>(memCall->getMethodDecl()->getParent());
+		auto* memExpr = dyn_cast<MemberExpr>(memCall->getCallee());
+		if(vecSpec && memExpr && memCall->getNumArgs() == 1)
+		{
+			QualType const elemType = vecSpec->getTemplateArgs()[0].getAsType();
+			QualType const argType = memCall->getArg(0)->getType();
+			if(elemType.getCanonicalType().getUnqualifiedType() ==
+			   argType.getCanonicalType().getUnqualifiedType())
+			{
+				pr.TraverseStmt(memExpr->isImplicitAccess() ? nullptr : memExpr->getBase());
+				pr.stream() << ".insertBack(";
+				pr.TraverseStmt(memCall->getArg(0));
+				pr.stream() << ')';
+				return;
+			}
+		}
+		printCppStdCall(pr, s, "emplace_back");
+	});
+
+	mc.methodPrinter("std::vector", "resize", [](DPrinter & pr, Stmt * s)
+	{
+		auto* memCall = dyn_cast<CXXMemberCallExpr>(s);
+		if(memCall == nullptr)
+			return;
+		auto* memExpr = dyn_cast<MemberExpr>(memCall->getCallee());
+		if(memExpr && (memCall->getNumArgs() == 1 || isa<CXXDefaultArgExpr>(memCall->getArg(1))))
+		{
+			pr.TraverseStmt(memExpr->isImplicitAccess() ? nullptr : memExpr->getBase());
+			pr.stream() << ".length = ";
+			pr.TraverseStmt(memCall->getArg(0));
+		}
+		else
+			printCppStdCall(pr, s, "resize");
+	});
+
+	mc.methodPrinter("std::vector", "shrink_to_fit", [](DPrinter & pr, Stmt * s)
+	{
+		printCppStdCall(pr, s, "shrink_to_fit");
+	});
+
+	mc.methodPrinter("std::vector", "data", [](DPrinter & pr, Stmt * s)
+	{
+		printCppStdCall(pr, s, "data");
+	});
+
+	mc.methodPrinter("std::vector", "insert", [](DPrinter & pr, Stmt * s)
+	{
+		auto* memCall = dyn_cast<CXXMemberCallExpr>(s);
+		auto* memExpr = memCall ? dyn_cast<MemberExpr>(memCall->getCallee()) : nullptr;
+		if(memExpr == nullptr || memCall->getNumArgs() == 0)
+			return;
+		pr.stream() << "cpp_std.insert(";
+		pr.TraverseStmt(memExpr->isImplicitAccess() ? nullptr : memExpr->getBase());
+		pr.stream() << ", ";
+		printVectorIndex(pr, memCall->getArg(0));
+		Expr* firstContainer = nullptr;
+		Expr* lastContainer = nullptr;
+		if(memCall->getNumArgs() == 3
+		   && getIteratorMethodName(memCall->getArg(1), firstContainer) == "begin"
+		   && getIteratorMethodName(memCall->getArg(2), lastContainer) == "end")
+		{
+			// All the elements of a container : Insert its range
+			pr.stream() << ", ";
+			pr.TraverseStmt(firstContainer);
+			pr.stream() << "[]";
+		}
+		else
+		{
+			for(unsigned i = 1; i < memCall->getNumArgs(); ++i)
+			{
+				pr.stream() << ", ";
+				pr.TraverseStmt(memCall->getArg(i));
+			}
+		}
+		pr.stream() << ')';
+		pr.addExternInclude("cpp_std", "cpp_std.insert");
+	});
+
 	for(char const* container : containerTab)
 	{
 		for(char const* meth : { "push_back", "emplace_back" })
@@ -200,6 +394,10 @@ void cpp_stdlib_port(MatchContainer& mc, MatchFinder& finder)
 
 	for(char const* container : containerTab)
 	{
+		// The cpp_std maps have an at method throwing if the key is missing, but opIndex insert it
+		std::string const name = container;
+		if(name == "std::map" || name == "std::unordered_map" || name == "boost::unordered_map")
+			continue;
 		mc.methodPrinter(container, "at", [](DPrinter & pr, Stmt * s)
 		{
 			if(auto* memCall = dyn_cast<CXXMemberCallExpr>(s))
@@ -214,18 +412,16 @@ void cpp_stdlib_port(MatchContainer& mc, MatchFinder& finder)
 			}
 		});
 	}
+}
 
-	mc.operatorCallPrinter(finder, "^::std::(__cxx11::)?(basic_)?string(<|$)", "+=",
-	                       [](DPrinter & pr, Stmt * s)
-	{
-		if(auto* opCall = dyn_cast<CXXOperatorCallExpr>(s))
-		{
-			pr.TraverseStmt(opCall->getArg(0));
-			pr.stream() << " ~= ";
-			pr.TraverseStmt(opCall->getArg(1));
-		}
-	});
+REG_CUSTOM_PRINTER_FOR(cpp_stdlib_containers_port,
+                       "vector", "array", "set", "map", "unordered_set", "unordered_map", "queue",
+                       "stack", "list", "forward_list", "deque", "boost/array.hpp",
+                       "boost/unordered_set.hpp", "boost/unordered_map.hpp", "boost/unordered/");
 
+//! Port of <memory>
+void cpp_stdlib_memory_port(MatchContainer& mc, MatchFinder& finder)
+{
 	//************************************ <memory> ***********************************************
 
 
@@ -370,7 +566,14 @@ void cpp_stdlib_port(MatchContainer& mc, MatchFinder& finder)
 			TemplateArgumentList const& tmpArgsSpec = tmpSpec->getTemplateInstantiationArgs();
 			TemplateArgument const& arg = tmpArgsSpec.get(0);
 			TypeOptions::Semantic const sem = DPrinter::getSemantic(arg.getAsType());
-			if(sem == TypeOptions::Value)
+			if(DPrinter::isMallocAllocated(arg.getAsType()))
+			{
+				printer.addExternInclude("cpp_std", "cpp_std.Unique");
+				printer.stream() << "cpp_std.Unique!(";
+				printer.printTemplateArgument(arg);
+				printer.stream() << ")";
+			}
+			else if(sem == TypeOptions::Value)
 			{
 				printer.addExternInclude("std.typecons", "RefCounted");
 				printer.stream() << "std.typecons.RefCounted!(";
@@ -390,6 +593,15 @@ void cpp_stdlib_port(MatchContainer& mc, MatchFinder& finder)
 			if(tmpArg)
 			{
 				TypeOptions::Semantic const sem = DPrinter::getSemantic(tmpArg->getAsType());
+				if(DPrinter::isMallocAllocated(tmpArg->getAsType()))
+				{
+					pr.stream() << "cpp_std.makeUnique!(";
+					pr.printTemplateArgument(*tmpArg);
+					pr.stream() << ")";
+					pr.printCallExprArgument(call);
+					pr.addExternInclude("cpp_std", "cpp_std.makeUnique");
+					return;
+				}
 				if(sem != TypeOptions::Value)
 					pr.stream() << "new ";
 				pr.printTemplateArgument(*tmpArg);
@@ -410,7 +622,9 @@ void cpp_stdlib_port(MatchContainer& mc, MatchFinder& finder)
 
 			pr.TraverseStmt(leftOp);
 			Expr* rightOp = opCall->getArg(1);
-			if(sem == TypeOptions::Value and isa<CXXNullPtrLiteralExpr>(rightOp))
+			if(tmpArg and DPrinter::isMallocAllocated(tmpArg->getAsType()) and isa<CXXNullPtrLiteralExpr>(rightOp))
+				pr.stream() << ".get is null";
+			else if(sem == TypeOptions::Value and isa<CXXNullPtrLiteralExpr>(rightOp))
 				pr.stream() << ".refCountedStore.isInitialized == false";
 			else
 			{
@@ -432,7 +646,9 @@ void cpp_stdlib_port(MatchContainer& mc, MatchFinder& finder)
 
 			pr.TraverseStmt(leftOp);
 			Expr* rightOp = opCall->getArg(1);
-			if(sem == TypeOptions::Value and isa<CXXNullPtrLiteralExpr>(rightOp))
+			if(tmpArg and DPrinter::isMallocAllocated(tmpArg->getAsType()) and isa<CXXNullPtrLiteralExpr>(rightOp))
+				pr.stream() << ".get !is null";
+			else if(sem == TypeOptions::Value and isa<CXXNullPtrLiteralExpr>(rightOp))
 				pr.stream() << ".refCountedStore.isInitialized";
 			else
 			{
@@ -441,7 +657,15 @@ void cpp_stdlib_port(MatchContainer& mc, MatchFinder& finder)
 			}
 		}
 	});
+}
+
+REG_CUSTOM_PRINTER_FOR(cpp_stdlib_memory_port,
+                       "memory", "bits/shared_ptr.h", "bits/unique_ptr.h", "boost/shared_ptr.hpp",
+                       "boost/make_shared.hpp", "boost/smart_ptr.hpp", "boost/smart_ptr/");
 
+//! Port of <functional>
+void cpp_stdlib_functional_port(MatchContainer& mc, MatchFinder& finder)
+{
 	// ******************************* <functional> ***********************************************
 
 	// std::hash
@@ -487,25 +711,56 @@ void cpp_stdlib_port(MatchContainer& mc, MatchFinder& finder)
 	};
 	mc.tmplTypePrinter("^::std::function", function_print);
 	mc.tmplTypePrinter("^::boost::function", function_print);
+}
+
+REG_CUSTOM_PRINTER_FOR(cpp_stdlib_functional_port,
+                       "functional", "bits/functional_hash.h", "xstddef", "xhash",
+                       "boost/function.hpp", "boost/function/");
 
+//! Port of <iostream>, <sstream>...
+void cpp_stdlib_iostream_port(MatchContainer& mc, MatchFinder& finder)
+{
 	// ********************** <iostream> **********************************************************
-	// std::cout
-	finder.addMatcher(
-	  declRefExpr(hasDeclaration(namedDecl(matchesName("cout")))).bind("std::cout"), &mc);
-	mc.stmtPrinters.emplace("std::cout", [](DPrinter & pr, Stmt*)
+	// std::cout, std::cerr : Global streams of cpp_std, keeping their formatting flags
+	for(char const* streamName : { "cout", "cerr" })
 	{
-		pr.stream() << "OStream(std.stdio.stdout)";
-		pr.addExternInclude("std.stdio", "std.stdio.stdout");
-		pr.addExternInclude("cpp_std", "OStream");
-	});
+		std::string const tag = std::string("std::") + streamName;
+		finder.addMatcher(
+		  declRefExpr(hasDeclaration(namedDecl(hasName("::" + tag)))).bind(tag), &mc);
+		mc.stmtPrinters.emplace(tag, [streamName](DPrinter & pr, Stmt*)
+		{
+			pr.stream() << "cpp_std." << streamName;
+			pr.addExternInclude("cpp_std", std::string("cpp_std.") + streamName);
+		});
+	}
 
-	// std::endl
-	finder.addMatcher(
-	  implicitCastExpr(hasSourceExpression(declRefExpr(hasDeclaration(namedDecl(matchesName("endl")))))).bind("std::endl"), &mc);
-	mc.stmtPrinters.emplace("std::endl", [](DPrinter & pr, Stmt*)
+	// std::endl (flush the stream, unlike '\n'), std::hex...
+	for(char const* manip : { "endl", "flush", "dec", "hex", "oct", "fixed", "scientific" })
 	{
-		pr.stream() << "\"\\n\"";
-	});
+		std::string const tag = std::string("std::") + manip;
+		finder.addMatcher(
+		  implicitCastExpr(hasSourceExpression(declRefExpr(hasDeclaration(namedDecl(hasName("::" + tag))))))
+		  .bind(tag), &mc);
+		mc.stmtPrinters.emplace(tag, [manip](DPrinter & pr, Stmt*)
+		{
+			pr.stream() << "cpp_std." << manip;
+			pr.addExternInclude("cpp_std", std::string("cpp_std.") + manip);
+		});
+	}
+
+	// <iomanip>
+	for(char const* manip : { "setw", "setprecision" })
+	{
+		mc.globalFuncPrinter(std::string("^::std::") + manip + "$", [manip](DPrinter & pr, Stmt * s)
+		{
+			if(auto* call = dyn_cast<CallExpr>(s))
+			{
+				pr.stream() << "cpp_std." << manip;
+				pr.printCallExprArgument(call);
+				pr.addExternInclude("cpp_std", std::string("cpp_std.") + manip);
+			}
+		});
+	}
 
 	Options::getInstance().types["class std::basic_stringstream<"].semantic = TypeOptions::Value;
 	Options::getInstance().types["class std::__cxx11::basic_stringstream<"].semantic = TypeOptions::Value;
@@ -520,7 +775,14 @@ void cpp_stdlib_port(MatchContainer& mc, MatchFinder& finder)
 		printer.addExternInclude("cpp_std", "cpp_std.ios_base");
 		printer.stream() << "cpp_std.ios_base";
 	});
+}
+
+REG_CUSTOM_PRINTER_FOR(cpp_stdlib_iostream_port,
+                       "iostream", "ostream", "istream", "ios", "sstream", "fstream", "iomanip");
 
+//! Port of <optional>
+void cpp_stdlib_optional_port(MatchContainer& mc, MatchFinder&)
+{
 	// ********************** <optional> **********************************************************
 	// std::optional
 	auto optional_to_bool = [](DPrinter & pr, Stmt * s)
@@ -537,24 +799,64 @@ void cpp_stdlib_port(MatchContainer& mc, MatchFinder& finder)
 	};
 	mc.methodPrinter("std::optional", "operator bool", optional_to_bool);
 	mc.methodPrinter("boost::optional", "operator bool", optional_to_bool);
+}
+
+REG_CUSTOM_PRINTER_FOR(cpp_stdlib_optional_port,
+                       "optional", "boost/optional.hpp", "boost/optional/");
 
+//! Port of <utility>
+void cpp_stdlib_utility_port(MatchContainer& mc, MatchFinder& finder)
+{
 	// ************************************** <utility> *******************************************
 
 	mc.globalFuncPrinter("^::std::move(<|$)", [](DPrinter & pr, Stmt * s)
 	{
 		if(auto* memCall = dyn_cast<CallExpr>(s))
 		{
-			pr.stream() << "cpp_std.move(";
-			pr.TraverseStmt(memCall->getArg(0));
-			pr.stream() << ")";
-			pr.addExternInclude("cpp_std", "cpp_std.move");
+			Expr* arg = memCall->getArg(0);
+			QualType const type = arg->getType();
+			if(type->isScalarType()) // Moving a scalar is copying it
+				pr.TraverseStmt(arg);
+			// A rvalue is already moved, and a const lvalue is copied in C++ (Both can't be reset)
+			else if(not arg->isLValue() or type.isConstQualified())
+				pr.TraverseStmt(arg);
+			else if(not type->isDependentType()
+			        && DPrinter::getSemantic(type) == TypeOptions::Value
+			        && not DPrinter::isPointer(type))
+			{
+				// Blit the struct and reset the source, without postblit nor destructor call
+				pr.stream() << "std.algorithm.mutation.move(";
+				pr.TraverseStmt(arg);
+				pr.stream() << ")";
+				pr.addExternInclude("std.algorithm.mutation", "std.algorithm.mutation.move");
+			}
+			else // Smart pointers (maybe class references) have to become null. Overloaded in cpp_std.
+			{
+				pr.stream() << "cpp_std.move(";
+				pr.TraverseStmt(arg);
+				pr.stream() << ")";
+				pr.addExternInclude("cpp_std", "cpp_std.move");
+			}
 		}
 	});
 
 	mc.globalFuncPrinter("^::std::forward(<|$)", [](DPrinter & pr, Stmt * s)
 	{
 		if(auto* memCall = dyn_cast<CallExpr>(s))
-			pr.TraverseStmt(memCall->getArg(0));
+		{
+			Expr* arg = memCall->getArg(0);
+			auto* declRef = dyn_cast<DeclRefExpr>(arg->IgnoreImpCasts());
+			if(declRef && isa<ParmVarDecl>(declRef->getDecl()))
+			{
+				// Parameters are taken by auto ref or by value (see DPrinter::getParamPassing)
+				pr.stream() << "std.functional.forward!(";
+				pr.TraverseStmt(arg);
+				pr.stream() << ")";
+				pr.addExternInclude("std.functional", "std.functional.forward");
+			}
+			else
+				pr.TraverseStmt(arg);
+		}
 	});
 
 
@@ -578,8 +880,19 @@ void cpp_stdlib_port(MatchContainer& mc, MatchFinder& finder)
 		if(auto* memExpr = dyn_cast<MemberExpr>(s))
 		{
 			Expr* base = memExpr->getBase();
-			pr.TraverseStmt(base);
-			pr.stream() << ".value";
+			auto* arrow = dyn_cast<CXXOperatorCallExpr>(base->IgnoreImpCasts());
+			if(arrow && arrow->getOperator() == OO_Arrow
+			   && isStdMapIterator(arrow->getArg(0)->getType()) && pr.isValueRead(memExpr))
+			{
+				// A cpp_std.map.Range copy a shared tree to give access to the value, not to read it
+				pr.TraverseStmt(arrow->getArg(0));
+				pr.stream() << ".readValue";
+			}
+			else
+			{
+				pr.TraverseStmt(base);
+				pr.stream() << ".value";
+			}
 		}
 	});
 
@@ -634,7 +947,15 @@ void cpp_stdlib_port(MatchContainer& mc, MatchFinder& finder)
 			pr.stream() << "]";
 		}
 	});
+}
 
+REG_CUSTOM_PRINTER_FOR(cpp_stdlib_utility_port,
+                       "utility", "xutility", "bits/stl_pair.h", "bits/move.h", "tuple",
+                       "algorithm");
+
+//! Port of <tuple>
+void cpp_stdlib_tuple_port(MatchContainer& mc, MatchFinder&)
+{
 	// ************************************ <tuple> *******************************************
 	// tuple
 	mc.tmplTypePrinter("^::std::tuple", [](DPrinter & printer, Decl * d)
@@ -654,7 +975,13 @@ void cpp_stdlib_port(MatchContainer& mc, MatchFinder& finder)
 		}
 	});
 	Options::getInstance().types["class std::tuple<"].semantic = TypeOptions::Value;
+}
 
+REG_CUSTOM_PRINTER_FOR(cpp_stdlib_tuple_port, "tuple");
+
+//! Port of <algorithm>
+void cpp_stdlib_algorithm_port(MatchContainer& mc, MatchFinder&)
+{
 	// ************************************ <algorithm> *******************************************
 	mc.globalFuncPrinter("^::std::max(<|$)", [](DPrinter & pr, Stmt * s)
 	{
@@ -675,7 +1002,13 @@ void cpp_stdlib_port(MatchContainer& mc, MatchFinder& finder)
 			pr.addExternInclude("std.algorithm", "std.algorithm.comparison.min");
 		}
 	});
+}
 
+REG_CUSTOM_PRINTER_FOR(cpp_stdlib_algorithm_port, "algorithm", "xutility", "bits/stl_algobase.h");
+
+//! Port of <string>
+void cpp_stdlib_string_port(MatchContainer& mc, MatchFinder& finder)
+{
 	// ************************************ <string> *******************************************
 	mc.globalFuncPrinter("^::std::to_string(<|$)", [](DPrinter & pr, Stmt * s)
 	{
@@ -687,14 +1020,41 @@ void cpp_stdlib_port(MatchContainer& mc, MatchFinder& finder)
 		}
 	});
 
-	mc.methodPrinter("std::basic_string", "c_str", [](DPrinter & pr, Stmt * s)
+	for(char const* meth : { "c_str", "data" })
 	{
-		if(auto* memCall = dyn_cast<CXXMemberCallExpr>(s))
+		mc.methodPrinter("std::basic_string", meth, [](DPrinter & pr, Stmt * s)
 		{
-			if(auto* memExpr = dyn_cast<MemberExpr>(memCall->getCallee()))
-				pr.TraverseStmt(memExpr->isImplicitAccess() ? nullptr : memExpr->getBase());
-		}
-	});
+			if(auto* memCall = dyn_cast<CXXMemberCallExpr>(s))
+			{
+				if(auto* memExpr = dyn_cast<MemberExpr>(memCall->getCallee()))
+					pr.TraverseStmt(memExpr->isImplicitAccess() ? nullptr : memExpr->getBase());
+			}
+		});
+	}
+
+	for(char const* meth : { "push_back", "append" })
+	{
+		mc.methodPrinter("std::basic_string", meth, [](DPrinter & pr, Stmt * s)
+		{
+			if(auto* memCall = dyn_cast<CXXMemberCallExpr>(s))
+			{
+				if(auto* memExpr = dyn_cast<MemberExpr>(memCall->getCallee()))
+				{
+					pr.TraverseStmt(memExpr->isImplicitAccess() ? nullptr : memExpr->getBase());
+					if(memCall->getNumArgs() == 1)
+					{
+						pr.stream() << " ~= ";
+						pr.TraverseStmt(memCall->getArg(0));
+					}
+					else
+					{
+						pr.stream() << '.' << memCall->getMethodDecl()->getNameAsString();
+						pr.printCallExprArgument(memCall);
+					}
+				}
+			}
+		});
+	}
 
 	mc.tmplTypePrinter("^::std::(__cxx11::)?basic_string", [](DPrinter & printer, Decl * d)
 	{
@@ -706,6 +1066,17 @@ void cpp_stdlib_port(MatchContainer& mc, MatchFinder& finder)
 			printer.stream() << ")[]";
 		}
 	});
+
+	mc.operatorCallPrinter(finder, "^::std::(__cxx11::)?(basic_)?string(<|$)", "+=",
+	                       [](DPrinter & pr, Stmt * s)
+	{
+		if(auto* opCall = dyn_cast<CXXOperatorCallExpr>(s))
+		{
+			pr.TraverseStmt(opCall->getArg(0));
+			pr.stream() << " ~= ";
+			pr.TraverseStmt(opCall->getArg(1));
+		}
+	});
 }
 
-REG_CUSTOM_PRINTER(cpp_stdlib_port);
+REG_CUSTOM_PRINTER_FOR(cpp_stdlib_string_port, "string", "xstring", "bits/basic_string.h");
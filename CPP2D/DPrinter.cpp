@@ -14,12 +14,18 @@
 #include <ciso646>
 #include <cstdio>
 #include <regex>
+#include <bitset>
+#include <unordered_set>
 
 #pragma warning(push, 0)
 #include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringSet.h>
 #include <llvm/ADT/APFloat.h>
 #include <llvm/Support/Path.h>
 #include <llvm/Support/ConvertUTF.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/MD5.h>
 #include <clang/AST/RecursiveASTVisitor.h>
 #include <clang/Frontend/CompilerInstance.h>
 #include <clang/Lex/Preprocessor.h>
@@ -29,6 +35,8 @@
 #pragma warning(pop)
 
 #include "MatchContainer.h"
+#include "CPP2DParallel.h"
+#include "SymbolIndex.h"
 #include "CPP2DTools.h"
 #include "Spliter.h"
 #include "CPP2DTools.h"
@@ -36,6 +44,9 @@
 using namespace llvm;
 using namespace clang;
 
+extern cl::list<std::string> MacroAsExpr;
+extern cl::list<std::string> MacroAsStmt;
+
 std::vector<std::unique_ptr<std::stringstream> > outStack;
 
 bool output_enabled = true;
@@ -64,7 +75,8 @@ std::string popStream()
 
 #define CHECK_LOC  if (checkFilename(Decl)) {} else return true
 
-static std::map<std::string, std::string> type2type =
+//! Qualified C++ type names to their **D** replacement (with module)
+static llvm::StringMap<std::string> const type2type =
 {
 	{ "boost::optional", "std.typecons.Nullable" },
 	{ "std::vector", "cpp_std.vector" },
@@ -92,8 +104,17 @@ static std::map<std::string, std::string> type2type =
 	{ "::rand", "core.stdc.stdlib.rand" },
 };
 
+//! Build a lookup table of kinds (indexed by kind)
+template<size_t Size, typename Kind>
+std::bitset<Size> makeKindSet(std::initializer_list<Kind> kinds)
+{
+	std::bitset<Size> kindSet;
+	for(Kind kind : kinds)
+		kindSet.set(static_cast<size_t>(kind));
+	return kindSet;
+}
 
-static const std::set<Decl::Kind> noSemiCommaDeclKind =
+static auto const noSemiCommaDeclKind = makeKindSet<Decl::Kind::lastDecl + 1>(
 {
 	Decl::Kind::CXXRecord,
 	Decl::Kind::Record,
@@ -110,9 +131,9 @@ static const std::set<Decl::Kind> noSemiCommaDeclKind =
 	Decl::Kind::Friend,
 	Decl::Kind::FunctionTemplate,
 	Decl::Kind::Enum,
-};
+});
 
-static const std::set<Stmt::StmtClass> noSemiCommaStmtKind =
+static auto const noSemiCommaStmtKind = makeKindSet<Stmt::StmtClass::lastStmtConstant + 1>(
 {
 	Stmt::StmtClass::ForStmtClass,
 	Stmt::StmtClass::IfStmtClass,
@@ -124,7 +145,7 @@ static const std::set<Stmt::StmtClass> noSemiCommaStmtKind =
 	Stmt::StmtClass::NullStmtClass,
 	Stmt::StmtClass::SwitchStmtClass,
 	//Stmt::StmtClass::DeclStmtClass,
-};
+});
 
 bool needSemiComma(Decl* decl)
 {
@@ -134,7 +155,7 @@ bool needSemiComma(Decl* decl)
 	else if (auto tmp = dyn_cast<ClassTemplateDecl>(decl))
 		return !tmp->hasBody();
 	else
-		return noSemiCommaDeclKind.count(kind) == 0;
+		return noSemiCommaDeclKind[kind] == false;
 }
 
 bool needSemiComma(Stmt* stmt)
@@ -149,30 +170,43 @@ bool needSemiComma(Stmt* stmt)
 	else
 	{
 		auto const kind = stmt->getStmtClass();
-		return noSemiCommaStmtKind.count(kind) == 0;
-	}
-}
+		return noSemiCommaStmtKind[kind] == false;
+	}
+}
+
+//! Identifiers which can't be used in **D** : keywords, and some names of the object module
+static llvm::StringSet<> const dReservedNames =
+{
+	"abstract", "alias", "align", "asm", "assert", "auto",
+	"body", "bool", "break", "byte",
+	"case", "cast", "catch", "cdouble", "cent", "cfloat", "char", "class", "const",
+	"continue", "creal",
+	"dchar", "debug", "default", "delegate", "delete", "deprecated", "do", "double",
+	"else", "enum", "export", "extern",
+	"false", "final", "finally", "float", "for", "foreach", "foreach_reverse", "function",
+	"goto",
+	"idouble", "if", "ifloat", "immutable", "import", "in", "inout", "int", "interface",
+	"invariant", "ireal", "is",
+	"lazy", "long",
+	"macro", "mixin", "module",
+	"new", "nothrow", "null",
+	"out", "override",
+	"package", "pragma", "private", "protected", "public", "pure",
+	"real", "ref", "return",
+	"scope", "shared", "short", "static", "struct", "super", "switch", "synchronized",
+	"template", "this", "throw", "true", "try", "typedef", "typeid", "typeof",
+	"ubyte", "ucent", "uint", "ulong", "union", "unittest", "ushort",
+	"version", "void", "volatile",
+	"wchar", "while", "with",
+	"__FILE__", "__FILE_FULL_PATH__", "__MODULE__", "__LINE__", "__FUNCTION__",
+	"__PRETTY_FUNCTION__", "__gshared", "__traits", "__vector", "__parameters",
+	"Exception",
+};
 
 std::string mangleName(std::string const& name)
 {
-	if(name == "version")
-		return "version_";
-	if(name == "out")
-		return "out_";
-	if(name == "in")
-		return "in_";
-	if(name == "ref")
-		return "ref_";
-	if(name == "debug")
-		return "debug_";
-	if(name == "function")
-		return "function_";
-	if(name == "cast")
-		return "cast_";
-	if(name == "align")
-		return "align_";
-	else if(name == "Exception")
-		return "Exception_";
+	if(dReservedNames.count(name) != 0)
+		return name + '_';
 	else
 		return name;
 }
@@ -186,41 +220,485 @@ static char const* AccessSpecifierStr[] =
 	//  (from the clang doxy)
 };
 
-void DPrinter::setIncludes(std::set<std::string> const& includes)
+void DPrinter::setIncludes(std::unordered_map<FileEntry const*, std::string> const& includes)
 {
-	includesInFile = includes;
+	includedModules = includes;
+	// Printed names and types depend on the includes (imports)
+	declNameCache.clear();
+	typeCache.clear();
+	tmplArgsCache.clear();
+	tmplSpecCache.clear();
 }
 
-void DPrinter::includeFile(std::string const& inclFile, std::string const& typeName)
+void DPrinter::setDeclCacheFile(std::string const& path)
 {
-	if(isInMacro)
-		return;
-	// For each #include find in the cpp
-	for(std::string include : includesInFile)
-	{
-		auto const pos = inclFile.find(include);
-		// TODO : Use llvm::path
-		// If the include is found in the file inclFile, import it
-		if(pos != std::string::npos &&
-		   pos == (inclFile.size() - include.size()) &&
-		   (pos == 0 || inclFile[pos - 1] == '/' || inclFile[pos - 1] == '\\'))
+	declCacheFile = path;
+}
+
+void DPrinter::setPrintJobs(unsigned jobs)
+{
+	printJobs = jobs;
+}
+
+namespace
+{
+char const* const DeclCacheHeader = "cpp2d-declcache 2";
+
+std::string md5(StringRef text)
+{
+	llvm::MD5 hasher;
+	hasher.update(text);
+	llvm::MD5::MD5Result result;
+	hasher.final(result);
+	return result.digest().str().str();
+}
+
+//! Find the declarations used by a declaration (see DPrinter::getDeclFingerprint)
+class DeclReferenceCollector : public RecursiveASTVisitor<DeclReferenceCollector>
+{
+public:
+	std::unordered_set<Decl const*> referenced;
+
+	bool VisitDeclRefExpr(DeclRefExpr* expr)
+	{
+		referenced.insert(expr->getDecl());
+		return true;
+	}
+
+	bool VisitMemberExpr(MemberExpr* expr)
+	{
+		referenced.insert(expr->getMemberDecl());
+		return true;
+	}
+
+	std::vector<ParmVarDecl*> parameters;
+	std::vector<CXXRecordDecl*> records; //!< Defined in the declaration
+
+	bool VisitCXXConstructExpr(CXXConstructExpr* expr)
+	{
+		referenced.insert(expr->getConstructor());
+		return true;
+	}
+
+	bool VisitParmVarDecl(ParmVarDecl* decl)
+	{
+		parameters.push_back(decl);
+		return true;
+	}
+
+	bool VisitCXXRecordDecl(CXXRecordDecl* decl)
+	{
+		if(decl->isThisDeclarationADefinition())
+			records.push_back(decl);
+		return true;
+	}
+
+	bool VisitTypeLoc(TypeLoc typeLoc)
+	{
+		QualType const type = typeLoc.getType();
+		if(type.isNull())
+			return true;
+		if(auto* typedefType = type->getAs<TypedefType>())
+			referenced.insert(typedefType->getDecl());
+		if(TagDecl* tag = type->getAsTagDecl())
+			referenced.insert(tag);
+		return true;
+	}
+};
+
+//! Find how the functions are called (see DPrinter::getParamPassing)
+class CallSiteCollector : public RecursiveASTVisitor<CallSiteCollector>
+{
+public:
+	std::unordered_set<FunctionDecl const*> addressTaken;
+	std::unordered_set<FunctionDecl const*> unresolvedCalls;
+	std::set<std::pair<FunctionDecl const*, unsigned>> rvalueArgs;
+
+	//! @param mutableStrings_ The local strings printed as char[], given as copied strings
+	explicit CallSiteCollector(std::unordered_set<VarDecl const*> const& mutableStrings_)
+		: mutableStrings(mutableStrings_)
+	{
+	}
+
+	//! Calls in instantiations are resolved, unlike in their template
+	bool shouldVisitTemplateInstantiations() const
+	{
+		return true;
+	}
+
+	bool VisitCallExpr(CallExpr* call)
+	{
+		callees.insert(call->getCallee()->IgnoreParenImpCasts());
+		FunctionDecl* func = call->getDirectCallee();
+		if(func == nullptr)
+			return true;
+		// The object of a member operator is not in the parameters
+		unsigned const firstArg = (isa<CXXOperatorCallExpr>(call) and isa<CXXMethodDecl>(func)) ? 1 : 0;
+		addArgs(func, call->arg_begin() + firstArg, call->arg_end());
+		return true;
+	}
+
+	bool VisitCXXConstructExpr(CXXConstructExpr* expr)
+	{
+		addArgs(expr->getConstructor(), expr->arg_begin(), expr->arg_end());
+		return true;
+	}
+
+	bool VisitDeclRefExpr(DeclRefExpr* expr)
+	{
+		if(auto* func = dyn_cast<FunctionDecl>(expr->getDecl()))
+			if(callees.count(expr) == 0)
+				addressTaken.insert(getPattern(func));
+		return true;
+	}
+
+	bool VisitMemberExpr(MemberExpr* expr)
+	{
+		if(auto* func = dyn_cast<FunctionDecl>(expr->getMemberDecl()))
+			if(callees.count(expr) == 0)
+				addressTaken.insert(getPattern(func));
+		return true;
+	}
+
+	//! UnresolvedLookupExpr and UnresolvedMemberExpr : The arguments are unknown
+	bool VisitOverloadExpr(OverloadExpr* expr)
+	{
+		for(NamedDecl* decl : expr->decls())
 		{
-			static std::string const hExt = ".h";
-			static std::string const hppExt = ".hpp";
-			if(include.find(hExt) == include.size() - hExt.size())
-				include = include.substr(0, include.size() - hExt.size());
-			if(include.find(hppExt) == include.size() - hppExt.size())
-				include = include.substr(0, include.size() - hppExt.size());
-			std::transform(std::begin(include), std::end(include),
-			               std::begin(include),
-			[](char c) {return static_cast<char>(tolower(c)); });
-			std::replace(std::begin(include), std::end(include), '/', '.');
-			std::replace(std::begin(include), std::end(include), '\\', '.');
-			std::replace(std::begin(include), std::end(include), '-', '_');
-			externIncludes[include].insert(typeName);
-			break;
+			NamedDecl* target = decl->getUnderlyingDecl();
+			if(auto* tmpl = dyn_cast<FunctionTemplateDecl>(target))
+				unresolvedCalls.insert(getPattern(tmpl->getTemplatedDecl()));
+			else if(auto* func = dyn_cast<FunctionDecl>(target))
+				unresolvedCalls.insert(getPattern(func));
+		}
+		return true;
+	}
+
+private:
+	//! The printed declaration of func (the template of an instantiation)
+	static FunctionDecl const* getPattern(FunctionDecl* func)
+	{
+		if(FunctionDecl* pattern = func->getTemplateInstantiationPattern())
+			func = pattern;
+		return func->getCanonicalDecl();
+	}
+
+	template<typename ArgIter>
+	void addArgs(FunctionDecl* func, ArgIter begin, ArgIter end)
+	{
+		FunctionDecl const* pattern = getPattern(func);
+		unsigned index = 0;
+		for(ArgIter iter = begin; iter != end; ++iter, ++index)
+		{
+			Expr const* arg = (*iter)->IgnoreImpCasts();
+			if(isa<MaterializeTemporaryExpr>(arg) or isa<CXXDefaultArgExpr>(arg) or not arg->isLValue())
+				rvalueArgs.emplace(pattern, index);
+			else if(auto* declRef = dyn_cast<DeclRefExpr>(arg->IgnoreParens()))
+			{
+				auto* var = dyn_cast<VarDecl>(declRef->getDecl());
+				if(var and mutableStrings.count(var))
+					rvalueArgs.emplace(pattern, index);
+			}
+		}
+	}
+
+	std::unordered_set<Expr const*> callees; //!< Callees are visited after their CallExpr
+	std::unordered_set<VarDecl const*> const& mutableStrings;
+};
+
+//! Find the local strings modified in place, and the ones which can't be char[] (see DPrinter::isMutableString)
+class StringMutationCollector : public RecursiveASTVisitor<StringMutationCollector>
+{
+public:
+	std::unordered_set<VarDecl const*> mutated;
+	std::unordered_set<VarDecl const*> aliased; //!< Pointed or bound to a reference
+
+	//! s += x
+	bool VisitCXXOperatorCallExpr(CXXOperatorCallExpr* call)
+	{
+		if(call->getOperator() == OO_PlusEqual)
+			addVar(mutated, call->getArg(0));
+		return true;
+	}
+
+	//! s[i] = c
+	bool VisitBinaryOperator(BinaryOperator* op)
+	{
+		if(op->isAssignmentOp())
+			if(auto* subscript = dyn_cast<CXXOperatorCallExpr>(op->getLHS()->IgnoreParenImpCasts()))
+				if(subscript->getOperator() == OO_Subscript)
+					addVar(mutated, subscript->getArg(0));
+		return true;
+	}
+
+	//! s.append(x), s.push_back(c), s.reserve(n)
+	bool VisitCXXMemberCallExpr(CXXMemberCallExpr* call)
+	{
+		if(CXXMethodDecl* method = call->getMethodDecl())
+		{
+			std::string const name = method->getNameAsString();
+			if(name == "append" or name == "push_back" or name == "reserve")
+				addVar(mutated, call->getImplicitObjectArgument());
+		}
+		return true;
+	}
+
+	bool VisitUnaryOperator(UnaryOperator* op)
+	{
+		if(op->getOpcode() == UO_AddrOf)
+			addVar(aliased, op->getSubExpr());
+		return true;
+	}
+
+	//! The implicit variables (like the range of a for) are not printed
+	bool VisitVarDecl(VarDecl* decl)
+	{
+		if(not decl->isImplicit() and decl->getType()->isReferenceType() and decl->hasInit())
+			addVar(aliased, decl->getInit());
+		return true;
+	}
+
+	bool VisitCallExpr(CallExpr* call)
+	{
+		if(FunctionDecl* func = call->getDirectCallee())
+		{
+			// The object of a member operator is not in the parameters
+			unsigned const firstArg = (isa<CXXOperatorCallExpr>(call) and isa<CXXMethodDecl>(func)) ? 1 : 0;
+			addRefArgs(func, call->arg_begin() + firstArg, call->arg_end());
+		}
+		return true;
+	}
+
+	bool VisitCXXConstructExpr(CXXConstructExpr* expr)
+	{
+		addRefArgs(expr->getConstructor(), expr->arg_begin(), expr->arg_end());
+		return true;
+	}
+
+private:
+	static void addVar(std::unordered_set<VarDecl const*>& vars, Expr* expr)
+	{
+		if(auto* declRef = dyn_cast<DeclRefExpr>(expr->IgnoreParenImpCasts()))
+			if(auto* var = dyn_cast<VarDecl>(declRef->getDecl()))
+				vars.insert(var);
+	}
+
+	//! The non-const references could be modified as string
+	template<typename ArgIter>
+	void addRefArgs(FunctionDecl* func, ArgIter begin, ArgIter end)
+	{
+		unsigned index = 0;
+		for(ArgIter iter = begin; iter != end and index < func->getNumParams(); ++iter, ++index)
+		{
+			QualType const paramType = func->getParamDecl(index)->getType();
+			if(auto* refType = paramType->getAs<ReferenceType>())
+				if(not refType->getPointeeType().isConstQualified())
+					addVar(aliased, *iter);
+		}
+	}
+};
+}
+
+DPrinter::DeclCache DPrinter::loadDeclCache() const
+{
+	DeclCache cache;
+	std::ifstream file(declCacheFile, std::ios::binary);
+	std::string header;
+	std::string contextHash;
+	size_t count = 0;
+	if(not std::getline(file, header) or header != DeclCacheHeader
+	   or not CPP2DTools::readString(file, contextHash) or contextHash != getContextHash()
+	   or not(file >> count))
+		return cache;
+	for(size_t i = 0; i < count; ++i)
+	{
+		std::string fingerprint;
+		CachedPrint code;
+		if(not CPP2DTools::readString(file, fingerprint) or not readCachedPrint(file, code))
+			return DeclCache();
+		cache.emplace(fingerprint, std::move(code));
+	}
+	return cache;
+}
+
+void DPrinter::saveDeclCache(DeclCache const& cache) const
+{
+	std::ofstream file(declCacheFile, std::ios::binary);
+	file << DeclCacheHeader << '\n';
+	CPP2DTools::writeString(file, getContextHash());
+	file << cache.size() << '\n';
+	for(auto const& fingerprint_n_code : cache)
+	{
+		CPP2DTools::writeString(file, fingerprint_n_code.first);
+		writeCachedPrint(file, fingerprint_n_code.second);
+	}
+}
+
+void DPrinter::writeCachedPrint(std::ostream& os, CachedPrint const& code)
+{
+	CPP2DTools::writeString(os, code.text);
+	os << code.imports.size() << '\n';
+	for(auto const& import : code.imports)
+	{
+		CPP2DTools::writeString(os, import.first);
+		CPP2DTools::writeString(os, import.second);
+	}
+}
+
+bool DPrinter::readCachedPrint(std::istream& is, CachedPrint& code)
+{
+	size_t importCount = 0;
+	if(not CPP2DTools::readString(is, code.text) or not(is >> importCount))
+		return false;
+	for(size_t j = 0; j < importCount; ++j)
+	{
+		std::string module;
+		std::string symbol;
+		if(not CPP2DTools::readString(is, module) or not CPP2DTools::readString(is, symbol))
+			return false;
+		code.imports.emplace_back(module, symbol);
+	}
+	return true;
+}
+
+std::string DPrinter::getContextHash() const
+{
+	std::stringstream context;
+	context << CPP2DTools::Version << '\n';
+	context << modulename << '\n';
+	std::set<std::string> const modules = [this]
+	{
+		std::set<std::string> result;
+		for(auto const& file_n_module : includedModules)
+			result.insert(file_n_module.second);
+		return result;
+	}();
+	for(std::string const& module : modules)
+		context << module << '\n';
+	std::map<std::string, int> const types = []
+	{
+		std::map<std::string, int> result;
+		for(auto const& name_n_options : Options::getInstance().types)
+			result.emplace(name_n_options.first, name_n_options.second.semantic);
+		return result;
+	}();
+	for(auto const& name_n_semantic : types)
+		context << name_n_semantic.first << '=' << name_n_semantic.second << '\n';
+	context << "valueClasses=" << Options::getInstance().valueClasses << '\n';
+	context << "mutableStrings=" << Options::getInstance().mutableStrings << '\n';
+	context << "uniqueOwner=" << Options::getInstance().uniqueOwner << '\n';
+	// The macros are transformed in the AST
+	for(std::string const& macro : MacroAsExpr)
+		context << "macro-expr=" << macro << '\n';
+	for(std::string const& macro : MacroAsStmt)
+		context << "macro-stmt=" << macro << '\n';
+	// The index changes the printed operators and the value classes
+	context << "index=" << SymbolIndex::getInstance().getContentHash() << '\n';
+	return md5(context.str());
+}
+
+std::string const& DPrinter::getSignatureHash(Decl const* decl)
+{
+	auto iter = signatureHashes.find(decl);
+	if(iter != signatureHashes.end())
+		return iter->second;
+
+	// The body of a function, is not part of its signature
+	Decl const* signatureDecl = decl;
+	SourceLocation end = decl->getLocEnd();
+	if(auto* func = dyn_cast<FunctionDecl>(decl))
+	{
+		if(func->doesThisDeclarationHaveABody())
+			end = func->getBody()->getLocStart();
+	}
+	else if(auto* tag = dyn_cast<TagDecl>(decl))
+	{
+		if(TagDecl const* definition = tag->getDefinition())
+		{
+			signatureDecl = definition;
+			end = definition->getLocEnd();
 		}
 	}
+	std::string signature = std::to_string(decl->getKind()) + '\n';
+	if(auto* namedDecl = dyn_cast<NamedDecl>(decl))
+		signature += namedDecl->getQualifiedNameAsString() + '\n';
+	signature += Lexer::getSourceText(
+	               CharSourceRange(SourceRange(signatureDecl->getLocStart(), end), true),
+	               Context->getSourceManager(),
+	               LangOptions()).str();
+	// With -value-classes, it depends on the uses of the record, which can be elsewhere
+	if(auto* record = dyn_cast<RecordDecl>(decl))
+		signature += isDClass(record) ? "\nclass" : "\nstruct";
+	return signatureHashes.emplace(decl, md5(signature)).first->second;
+}
+
+std::string DPrinter::getDeclFingerprint(Decl* decl, SourceLocation locStart)
+{
+	auto& sm = Context->getSourceManager();
+	SourceLocation begin = decl->getLocStart();
+	if(begin.isMacroID() or decl->getLocEnd().isMacroID())
+		return std::string();
+	if(locStart.isValid() and not locStart.isMacroID()
+	   and sm.isBeforeInTranslationUnit(locStart, begin))
+		begin = locStart;
+	std::string text = Lexer::getSourceText(
+	                     CharSourceRange(SourceRange(begin, decl->getLocEnd()), true),
+	                     sm,
+	                     LangOptions()).str();
+	if(text.empty())
+		return std::string();
+
+	DeclReferenceCollector collector;
+	collector.TraverseDecl(decl);
+	std::set<std::string> signatures; // Sorted to not depend on the pointers order
+	for(Decl const* referenced : collector.referenced)
+	{
+		if(referenced != nullptr)
+			signatures.insert(getSignatureHash(referenced));
+	}
+	for(std::string const& signature : signatures)
+		text += '\n' + signature;
+	// The passing of parameters depend on the call sites, which can be elsewhere
+	text += '\n';
+	for(ParmVarDecl* param : collector.parameters)
+		text += char('0' + static_cast<int>(getParamPassing(param)));
+	// The free operators and the hash trait, matched or indexed, are printed in their record
+	SymbolIndex const& symbolIndex = SymbolIndex::getInstance();
+	for(CXXRecordDecl* record : collector.records)
+	{
+		std::set<std::string> printedInRecord; // Sorted to not depend on the matching order
+		auto getSourceText = [&](Decl const* printed)
+		{
+			return Lexer::getSourceText(
+			         CharSourceRange::getTokenRange(printed->getSourceRange()), sm, LangOptions()).str();
+		};
+		RecordExtras const extras = getRecordExtras(record);
+		for(FunctionDecl const* freeOperator : extras.leftOperators)
+			printedInRecord.insert("left " + getSourceText(freeOperator));
+		for(FunctionDecl const* freeOperator : extras.rightOperators)
+			printedInRecord.insert("right " + getSourceText(freeOperator));
+		if(extras.hashMethod)
+			printedInRecord.insert("hash " + getSourceText(extras.hashMethod));
+		for(std::string const& printed : printedInRecord)
+			text += '\n' + printed;
+		text += isDClass(record) ? "\nclass" : "\nstruct";
+		if(symbolIndex.isLoaded())
+			text += "\nindex " + std::to_string(symbolIndex.getRecordFlags(record));
+	}
+	return md5(text);
+}
+
+void DPrinter::includeFile(Decl const* decl, std::string const& typeName)
+{
+	if(isInMacro)
+		return;
+	FileEntry const* file = CPP2DTools::getFileEntry(Context->getSourceManager(), decl);
+	if(file == nullptr)
+		return;
+	// If the file was included in the cpp, import it
+	auto const iter = includedModules.find(file);
+	if(iter != includedModules.end())
+		addExternInclude(iter->second, typeName);
 }
 
 void DPrinter::printDeclContext(DeclContext* DC)
@@ -252,7 +730,53 @@ void DPrinter::printDeclContext(DeclContext* DC)
 	}
 }
 
+unsigned DPrinter::printFlags() const
+{
+	return (refAccepted ? 1u : 0u) |
+	       (inFuncParams ? 2u : 0u) |
+	       (portConst ? 4u : 0u) |
+	       (inTemplateParamList ? 8u : 0u) |
+	       (inForRangeInit ? 16u : 0u);
+}
+
+template<typename PrintFunc>
+DPrinter::CachedPrint DPrinter::recordImports(PrintFunc print)
+{
+	CachedPrint cached;
+	importRecorders.push_back(&cached.imports);
+	cached.text = print();
+	importRecorders.pop_back();
+	return cached;
+}
+
+void DPrinter::replayImports(CachedPrint const& cached)
+{
+	for(auto const& import : cached.imports)
+		addExternInclude(import.first, import.second);
+}
+
 std::string DPrinter::printDeclName(NamedDecl* decl)
+{
+	// Imports are not recorded inside macros, and without output the context is not printed
+	if(isInMacro || not output_enabled)
+		return printDeclNameImpl(decl);
+	// In a dependent context, the printing depend on the current template arguments
+	DeclContext* ctx = decl->getDeclContext();
+	if(ctx && ctx->isDependentContext())
+		return printDeclNameImpl(decl);
+
+	auto const key = std::make_pair(decl, printFlags());
+	auto iter = declNameCache.find(key);
+	if(iter != declNameCache.end())
+	{
+		replayImports(iter->second);
+		return iter->second.text;
+	}
+	CachedPrint cached = recordImports([&] {return printDeclNameImpl(decl); });
+	return declNameCache.emplace(key, std::move(cached)).first->second.text;
+}
+
+std::string DPrinter::printDeclNameImpl(NamedDecl* decl)
 {
 	NamedDecl* canDecl = nullptr;
 	std::string const& name = decl->getNameAsString();
@@ -272,13 +796,13 @@ std::string DPrinter::printDeclName(NamedDecl* decl)
 	if(qualTypeToD != type2type.end())
 	{
 		//There is a convertion to D
-		auto const& dQualType = qualTypeToD->second;
+		auto const& dQualType = qualTypeToD->getValue();
 		auto const dotPos = dQualType.find_last_of('.');
 		auto const module = dotPos == std::string::npos ?
 		                    std::string() :
 		                    dQualType.substr(0, dotPos);
 		if(not module.empty())  //Need an import
-			externIncludes[module].insert(qualName);
+			addExternInclude(module, qualName);
 		if(dotPos == std::string::npos)
 			return result + dQualType;
 		else
@@ -287,7 +811,7 @@ std::string DPrinter::printDeclName(NamedDecl* decl)
 	else
 	{
 		NamedDecl const* usedDecl = canDecl ? canDecl : decl;
-		includeFile(CPP2DTools::getFile(Context->getSourceManager(), usedDecl), qualName);
+		includeFile(usedDecl, qualName);
 		return result + mangleName(name);
 	}
 }
@@ -617,15 +1141,30 @@ static PrintingPolicy getPrintingPolicy()
 }
 
 clang::PrintingPolicy DPrinter::printingPolicy = getPrintingPolicy();
+std::unordered_map<void*, DPrinter::TypeTraits> DPrinter::typeTraitsCache;
+std::unordered_map<CXXRecordDecl const*, DPrinter::RecordTraits> DPrinter::recordTraitsCache;
 
 DPrinter::DPrinter(
   ASTContext* Context,
-  MatchContainer const& receiver,
+  MatchContainer& receiver,
   StringRef file)
 	: Context(Context)
 	, receiver(receiver)
 	, modulename(llvm::sys::path::stem(file))
 {
+	// Types and decls of the previous clang::ASTContext are not valid anymore
+	clearTraitsCaches();
+}
+
+DPrinter::~DPrinter()
+{
+	clearTraitsCaches(); // The ASTContext is about to be freed
+}
+
+void DPrinter::clearTraitsCaches()
+{
+	typeTraitsCache.clear();
+	recordTraitsCache.clear();
 }
 
 std::string DPrinter::indentStr() const
@@ -633,26 +1172,138 @@ std::string DPrinter::indentStr() const
 	return std::string(indent * 4, ' '); //-V112
 }
 
-bool DPrinter::isA(CXXRecordDecl* decl, std::string const& baseName)
+DPrinter::RecordTraits const& DPrinter::getRecordTraits(CXXRecordDecl* decl)
 {
+	auto iter = recordTraitsCache.find(decl);
+	if(iter != recordTraitsCache.end())
+		return iter->second;
+
+	RecordTraits traits;
 	std::string declName = decl->getQualifiedNameAsString();
-	if(declName == baseName)
-		return true;
-	for(CXXBaseSpecifier const& baseSpec : decl->bases())
+	traits.qualNames.insert(declName);
+	size_t pos = declName.find('<');
+	if(pos != std::string::npos)
+		declName = declName.substr(0, pos);
+	traits.lineage.push_back(declName);
+	auto addBase = [&](CXXBaseSpecifier const & baseSpec)
 	{
 		CXXRecordDecl* base = baseSpec.getType()->getAsCXXRecordDecl();
 		assert(base);
-		if(isA(base, baseName))
-			return true;
-	}
+		RecordTraits const& baseTraits = getRecordTraits(base);
+		traits.qualNames.insert(std::begin(baseTraits.qualNames), std::end(baseTraits.qualNames));
+		traits.lineage.insert(std::end(traits.lineage),
+		                      std::begin(baseTraits.lineage),
+		                      std::end(baseTraits.lineage));
+	};
+	for(CXXBaseSpecifier const& baseSpec : decl->bases())
+		addBase(baseSpec);
 	for(CXXBaseSpecifier const& baseSpec : decl->vbases())
+		addBase(baseSpec);
+	return recordTraitsCache.emplace(decl, std::move(traits)).first->second;
+}
+
+bool DPrinter::isA(CXXRecordDecl* decl, std::string const& baseName)
+{
+	return getRecordTraits(decl).qualNames.count(baseName) != 0;
+}
+
+DPrinter::CachedPrint DPrinter::printTopLevelDecl(clang::Decl* decl, SourceLocation locStart)
+{
+	return recordImports([&]
 	{
-		CXXRecordDecl* base = baseSpec.getType()->getAsCXXRecordDecl();
-		assert(base);
-		if(isA(base, baseName))
-			return true;
+		pushStream();
+		pushStream();
+
+		printStmtComment(locStart,
+			decl->getSourceRange().getBegin(),
+			decl->getSourceRange().getEnd(),
+			true
+		);
+
+		TraverseDecl(decl);
+		std::string const declStr = popStream();
+		if (not declStr.empty())
+		{
+			printCommentBefore(decl);
+			out() << indentStr() << declStr;
+			if (needSemiComma(decl))
+				out() << ';';
+			printCommentAfter(decl);
+		}
+		return popStream();
+	});
+}
+
+int DPrinter::getMacroDepthChange(clang::Decl* decl)
+{
+	// Like in printStmtMacro
+	auto* varDecl = dyn_cast<VarDecl>(decl);
+	if(varDecl == nullptr)
+		return 0;
+	std::string const varName = varDecl->getNameAsString();
+	if(varName.find("CPP2D_MACRO_STMT_END") == 0)
+		return -1;
+	else if(varName.find("CPP2D_MACRO_STMT") == 0)
+		return 1;
+	return 0;
+}
+
+void DPrinter::collectRenamedIdentifiers(clang::Decl* decl, std::vector<IdentifierInfo*>& renames)
+{
+	// Like in printTemplateSpec_TmpArgsAndParms
+	if(auto* partialSpec = dyn_cast<ClassTemplatePartialSpecializationDecl>(decl))
+	{
+		for(NamedDecl* parmDecl : *partialSpec->getTemplateParameters())
+		{
+			if(IdentifierInfo* info = parmDecl->getIdentifier())
+				renames.push_back(info);
+		}
 	}
-	return false;
+	if(isa<NamespaceDecl>(decl) or isa<LinkageSpecDecl>(decl) or isa<CXXRecordDecl>(decl))
+	{
+		for(clang::Decl* child : cast<DeclContext>(decl)->decls())
+			collectRenamedIdentifiers(child, renames);
+	}
+	else if(auto* tmpl = dyn_cast<ClassTemplateDecl>(decl))
+		collectRenamedIdentifiers(tmpl->getTemplatedDecl(), renames);
+}
+
+void DPrinter::printInProcesses(std::vector<TopLevelDecl>& decls,
+                                std::vector<IdentifierInfo*> const& renames)
+{
+	std::vector<TopLevelDecl*> toPrint;
+	for(TopLevelDecl& decl : decls)
+	{
+		if(not decl.cached)
+			toPrint.push_back(&decl);
+	}
+	// Each declaration is printed in the state the previous ones would let in a single process
+	auto print = [&](size_t index)
+	{
+		TopLevelDecl const& decl = *toPrint[index];
+		isInMacro = decl.macroDepth;
+		output_enabled = (isInMacro == 0);
+		renamedIdentifiers.clear();
+		for(size_t i = 0; i != decl.renameCount; ++i)
+			renamedIdentifiers[renames[i]] = renames[i]->getName().str() + "_";
+		return printTopLevelDecl(decl.decl, decl.locStart);
+	};
+	std::vector<std::string> const results = runInProcesses(toPrint.size(), printJobs, [&](size_t index)
+	{
+		std::stringstream result;
+		writeCachedPrint(result, print(index));
+		return result.str();
+	});
+	for(size_t index = 0; index != toPrint.size(); ++index)
+	{
+		// If the processes failed, print here
+		std::stringstream result(results.empty() ? std::string() : results[index]);
+		if(results.empty() or not readCachedPrint(result, toPrint[index]->code))
+			toPrint[index]->code = print(index);
+	}
+	renamedIdentifiers.clear();
+	for(IdentifierInfo* info : renames)
+		renamedIdentifiers[info] = info->getName().str() + "_";
 }
 
 bool DPrinter::TraverseTranslationUnitDecl(TranslationUnitDecl* Decl)
@@ -671,6 +1322,14 @@ bool DPrinter::TraverseTranslationUnitDecl(TranslationUnitDecl* Decl)
 	std::ofstream file2(modulename + ".source.cpp");
 	auto& sm = Context->getSourceManager();
 
+	DeclCache const oldDeclCache = declCacheFile.empty() ? DeclCache() : loadDeclCache();
+	DeclCache newDeclCache;
+
+	// With many printJobs, the declarations are printed after this loop, by other processes
+	std::vector<TopLevelDecl> pendingDecls;
+	std::vector<IdentifierInfo*> renames; //!< Added to renamedIdentifiers by the pendingDecls
+	int macroDepth = 0; //!< isInMacro after the pendingDecls
+
 	for(clang::Decl* c : Decl->decls())
 	{
 		std::string decl_str =
@@ -682,33 +1341,66 @@ bool DPrinter::TraverseTranslationUnitDecl(TranslationUnitDecl* Decl)
 
 		if (CPP2DTools::checkFilename(Context->getSourceManager(), modulename, c))
 		{
-			pushStream();
-
 			if (locStart.isInvalid())
 				locStart = sm.getLocForStartOfFile(sm.getMainFileID());
 
-			printStmtComment(locStart,
-				c->getSourceRange().getBegin(),
-				c->getSourceRange().getEnd(),
-				true
-			);
+			bool const printNow = printJobs <= 1;
+			int const depth = printNow ? isInMacro : macroDepth;
+			std::string fingerprint;
+			CachedPrint code;
+			bool cached = false;
+			if (not declCacheFile.empty() and depth == 0)
+			{
+				fingerprint = getDeclFingerprint(c, locStart);
+				auto iter = oldDeclCache.find(fingerprint);
+				if (not fingerprint.empty() and iter != oldDeclCache.end())
+				{
+					code = iter->second;
+					cached = true;
+				}
+			}
 
-			TraverseDecl(c);
-			std::string const decl = popStream();
-			if (not decl.empty())
+			if (printNow)
+			{
+				if (cached)
+					replayImports(code);
+				else
+					code = printTopLevelDecl(c, locStart);
+				out() << code.text;
+				if (not fingerprint.empty())
+					newDeclCache.emplace(fingerprint, code);
+				output_enabled = (isInMacro == 0);
+			}
+			else
 			{
-				printCommentBefore(c);
-				out() << indentStr() << decl;
-				if (needSemiComma(c))
-					out() << ';';
-				printCommentAfter(c);
+				pendingDecls.push_back(
+				  TopLevelDecl{ c, locStart, depth, renames.size(), fingerprint, cached, code });
+				macroDepth += getMacroDepthChange(c);
+				collectRenamedIdentifiers(c, renames);
 			}
-			output_enabled = (isInMacro == 0);
+			locStart = c->getSourceRange().getEnd(); // As done by printStmtComment
 		}
 	}
 
+	if (not pendingDecls.empty())
+	{
+		printInProcesses(pendingDecls, renames);
+		for(TopLevelDecl const& pending : pendingDecls)
+		{
+			replayImports(pending.code);
+			out() << pending.code.text;
+			if (not pending.fingerprint.empty())
+				newDeclCache.emplace(pending.fingerprint, pending.code);
+		}
+		isInMacro = macroDepth;
+		output_enabled = (isInMacro == 0);
+	}
+
 	printStmtComment(locStart, sm.getLocForEndOfFile(sm.getMainFileID()), clang::SourceLocation(), true);
 
+	if (not declCacheFile.empty())
+		saveDeclCache(newDeclCache);
+
 	return true;
 }
 
@@ -774,7 +1466,7 @@ bool DPrinter::TraverseFieldDecl(FieldDecl* Decl)
 		out() << ", \"" << mangleName(varName) << "\", ";
 		TraverseStmt(Decl->getBitWidth());
 		out() << ',';
-		externIncludes["std.bitmanip"].insert("bitfields");
+		addExternInclude("std.bitmanip", "bitfields");
 	}
 	else
 	{
@@ -901,10 +1593,12 @@ bool DPrinter::TraverseTemplateSpecializationType(TemplateSpecializationType* Ty
 	}
 	else if(isStdUnorderedMap(Type->desugar()))
 	{
-		printTemplateArgument(Type->getArg(1));
-		out() << '[';
+		addExternInclude("cpp_std", "cpp_std.unordered_map");
+		out() << "cpp_std.unordered_map!(";
 		printTemplateArgument(Type->getArg(0));
-		out() << ']';
+		out() << ", ";
+		printTemplateArgument(Type->getArg(1));
+		out() << ')';
 		return true;
 	}
 	out() << printDeclName(Type->getTemplateName().getAsTemplateDecl());
@@ -1119,7 +1813,7 @@ void DPrinter::printBasesClass(CXXRecordDecl* decl)
 bool DPrinter::TraverseCXXRecordDecl(CXXRecordDecl* decl)
 {
 	if(passDecl(decl)) return true;
-	if(decl->isClass())
+	if(isDClass(decl))
 	{
 		for(auto* ctor : decl->ctors())
 		{
@@ -1156,9 +1850,8 @@ void DPrinter::traverseCXXRecordDeclImpl(
 	if(decl->isCompleteDefinition() == false && decl->getDefinition() != nullptr)
 		return;
 
-	const bool isClass = decl->isClass();
 	char const* struct_class =
-	  decl->isClass() ? "class" :
+	  isDClass(decl) ? "class" :
 	  decl->isUnion() ? "union" :
 	  "struct";
 	TypedefNameDecl* typedefDecl = decl->getTypedefNameForAnonDecl();
@@ -1252,29 +1945,30 @@ void DPrinter::traverseCXXRecordDeclImpl(
 	out() << std::endl;
 
 	//Print all free operator inside the class scope
-	auto record_name = decl->getTypeForDecl()->getCanonicalTypeInternal().getAsString();
-	for(auto rng = receiver.freeOperator.equal_range(record_name);
-	    rng.first != rng.second;
-	    ++rng.first)
+	RecordExtras const extras = getRecordExtras(decl);
+	for(FunctionDecl* freeOperator : extras.leftOperators)
 	{
 		out() << indentStr();
-		traverseFunctionDeclImpl(const_cast<FunctionDecl*>(rng.first->second), 0);
+		traverseFunctionDeclImpl(freeOperator, 0);
 		out() << std::endl;
 	}
-	for(auto rng = receiver.freeOperatorRight.equal_range(record_name);
-	    rng.first != rng.second;
-	    ++rng.first)
+	for(FunctionDecl* freeOperator : extras.rightOperators)
 	{
 		out() << indentStr();
-		traverseFunctionDeclImpl(const_cast<FunctionDecl*>(rng.first->second), 1);
+		traverseFunctionDeclImpl(freeOperator, 1);
 		out() << std::endl;
 	}
 
+	// The std::hash specialization become the toHash method (used by cpp_std.hashKey)
+	if(extras.hashMethod && not isDClass(decl))
+		printToHash(extras.hashMethod);
+
 	// print the opCmd operator
+	// The relations are known from the operators printed above, so _opLess and _opExclaim exist
 	if(auto* cxxRecordDecl = dyn_cast<CXXRecordDecl>(decl))
 	{
-		ClassInfo const& classInfo = classInfoMap[cxxRecordDecl];
-		for(auto && type_info : classInfoMap[cxxRecordDecl].relations)
+		ClassInfo& classInfo = classInfoMap[cxxRecordDecl];
+		for(auto && type_info : classInfo.relations)
 		{
 			clang::Type const* type = type_info.first;
 			RelationInfo& info = type_info.second;
@@ -1312,6 +2006,84 @@ void DPrinter::traverseCXXRecordDeclImpl(
 	out() << indentStr() << "}";
 }
 
+DPrinter::RecordExtras DPrinter::getRecordExtras(RecordDecl const* decl)
+{
+	RecordExtras extras;
+	std::string const recordName = decl->getTypeForDecl()->getCanonicalTypeInternal().getAsString();
+	std::unordered_set<Decl const*> matched; // Canonical declarations
+	for(auto rng = receiver.freeOperator.equal_range(recordName); rng.first != rng.second; ++rng.first)
+	{
+		extras.leftOperators.push_back(const_cast<FunctionDecl*>(rng.first->second));
+		matched.insert(rng.first->second->getCanonicalDecl());
+	}
+	for(auto rng = receiver.freeOperatorRight.equal_range(recordName); rng.first != rng.second; ++rng.first)
+	{
+		extras.rightOperators.push_back(const_cast<FunctionDecl*>(rng.first->second));
+		matched.insert(rng.first->second->getCanonicalDecl());
+	}
+	auto const hashTrait = receiver.hashTraits.find(recordName);
+	if(hashTrait != receiver.hashTraits.end())
+		extras.hashMethod = const_cast<CXXMethodDecl*>(hashTrait->second);
+
+	// Declared in an other module, but maybe defined in this translation unit (in a header)
+	SymbolIndex const& symbolIndex = SymbolIndex::getInstance();
+	auto* cxxRecordDecl = dyn_cast<CXXRecordDecl>(decl);
+	if(not symbolIndex.isLoaded() or cxxRecordDecl == nullptr)
+		return extras;
+	for(auto const& usr_n_flags : symbolIndex.getLinks(cxxRecordDecl))
+	{
+		Decl const* definition = symbolIndex.findLocalDefinition(usr_n_flags.first);
+		if(definition == nullptr)
+			continue; // Not printable from this module
+		if(usr_n_flags.second & SymbolIndex::FreeOperator)
+		{
+			auto* func = const_cast<FunctionDecl*>(cast<FunctionDecl>(definition));
+			if(matched.insert(func->getCanonicalDecl()).second)
+			{
+				if(usr_n_flags.second & SymbolIndex::RightSide)
+					extras.rightOperators.push_back(func);
+				else
+					extras.leftOperators.push_back(func);
+			}
+		}
+		else if((usr_n_flags.second & SymbolIndex::HashTrait) and extras.hashMethod == nullptr)
+		{
+			for(CXXMethodDecl* method : cast<CXXRecordDecl>(definition)->methods())
+			{
+				if(method->getOverloadedOperator() == OO_Call)
+					extras.hashMethod = method;
+			}
+		}
+	}
+	return extras;
+}
+
+void DPrinter::printToHash(CXXMethodDecl* hashMethod)
+{
+	auto* body = dyn_cast_or_null<CompoundStmt>(hashMethod->getBody());
+	if(body == nullptr || hashMethod->getNumParams() != 1)
+		return;
+	// The body use the key by its name, so it become a static function called on this
+	ParmVarDecl* key = hashMethod->getParamDecl(0);
+	out() << indentStr() << "static size_t toHashOf(ref ";
+	printType(key->getType().getNonReferenceType());
+	std::string const keyName = getName(key->getDeclName());
+	if(not keyName.empty())
+		out() << " " << mangleName(keyName);
+	out() << ")" << std::endl << indentStr();
+	traverseCompoundStmtImpl(body, [] {}, [] {});
+	out() << "\n";
+	out() << indentStr() << "size_t toHash()";
+	if(portConst)
+		out() << " const";
+	out() << "\n";
+	out() << indentStr() << "{\n";
+	++indent;
+	out() << indentStr() << "return toHashOf(this);\n";
+	--indent;
+	out() << indentStr() << "}\n";
+}
+
 void DPrinter::printTemplateParameterList(TemplateParameterList* tmpParams,
     std::string const& prevTmplParmsStr)
 {
@@ -1411,11 +2183,79 @@ void DPrinter::printTemplateArgument(TemplateArgument const& ta)
 			split.split(), printTemplateArgument(arg);
 		break;
 	}
-	default: TraverseTemplateArgument(ta);
+	default: TraverseTemplateArgument(ta);
+	}
+}
+
+void DPrinter::printTemplateSpec_TmpArgsAndParms(
+  TemplateParameterList& primaryTmpParams,
+  TemplateArgumentList const& tmpArgs,
+  const ASTTemplateArgumentListInfo* tmpArgsInfo,
+  TemplateParameterList* newTmpParams,
+  std::string const& prevTmplParmsStr
+)
+{
+	assert(tmpArgs.size() == primaryTmpParams.size());
+	if(newTmpParams)
+	{
+		for(decltype(newTmpParams->size()) i = 0, size = newTmpParams->size(); i != size; ++i)
+		{
+			NamedDecl* parmDecl = newTmpParams->getParam(i);
+			IdentifierInfo* info = parmDecl->getIdentifier();
+			std::string name = info->getName().str() + "_";
+			renamedIdentifiers[info] = name;
+		}
+	}
+
+	auto print = [&]
+	{
+		pushStream();
+		printTemplateSpec_TmpArgsAndParmsImpl(
+		  primaryTmpParams, tmpArgs, tmpArgsInfo, newTmpParams, prevTmplParmsStr);
+		return popStream();
+	};
+	// Imports are not recorded inside macros, and without output the context is not printed
+	if(isInMacro || not output_enabled)
+	{
+		out() << print();
+		return;
 	}
+	// tmpArgs belong to one specialization, so the printing only depend on the other keys
+	decltype(tmplSpecCache)::key_type key(
+	  &tmpArgs, tmpArgsInfo, newTmpParams, prevTmplParmsStr, printFlags());
+	auto iter = tmplSpecCache.find(key);
+	if(iter == tmplSpecCache.end())
+		iter = tmplSpecCache.emplace(std::move(key), recordImports(print)).first;
+	else
+		replayImports(iter->second);
+	out() << iter->second.text;
 }
 
-void DPrinter::printTemplateSpec_TmpArgsAndParms(
+std::string DPrinter::printTemplateArgs(TemplateArgumentList const& tmpArgs)
+{
+	auto print = [&]
+	{
+		pushStream();
+		Spliter spliter(*this, ", ");
+		for(unsigned int i = 0, size = tmpArgs.size(); i != size; ++i)
+		{
+			spliter.split();
+			printTemplateArgument(tmpArgs.get(i));
+		}
+		return popStream();
+	};
+	if(isInMacro || not output_enabled)
+		return print();
+	auto const key = std::make_pair(&tmpArgs, printFlags());
+	auto iter = tmplArgsCache.find(key);
+	if(iter == tmplArgsCache.end())
+		iter = tmplArgsCache.emplace(key, recordImports(print)).first;
+	else
+		replayImports(iter->second);
+	return iter->second.text;
+}
+
+void DPrinter::printTemplateSpec_TmpArgsAndParmsImpl(
   TemplateParameterList& primaryTmpParams,
   TemplateArgumentList const& tmpArgs,
   const ASTTemplateArgumentListInfo* tmpArgsInfo,
@@ -1423,7 +2263,6 @@ void DPrinter::printTemplateSpec_TmpArgsAndParms(
   std::string const& prevTmplParmsStr
 )
 {
-	assert(tmpArgs.size() == primaryTmpParams.size());
 	out() << '(';
 	Spliter spliter2(*this, ", ");
 	if(prevTmplParmsStr.empty() == false)
@@ -1431,16 +2270,6 @@ void DPrinter::printTemplateSpec_TmpArgsAndParms(
 		spliter2.split();
 		out() << prevTmplParmsStr;
 	}
-	if(newTmpParams)
-	{
-		for(decltype(newTmpParams->size()) i = 0, size = newTmpParams->size(); i != size; ++i)
-		{
-			NamedDecl* parmDecl = newTmpParams->getParam(i);
-			IdentifierInfo* info = parmDecl->getIdentifier();
-			std::string name = info->getName().str() + "_";
-			renamedIdentifiers[info] = name;
-		}
-	}
 
 	auto printRedefinedTmp = [&](NamedDecl * tmpl, TemplateArgument const & tmplDef)
 	{
@@ -1665,9 +2494,24 @@ bool DPrinter::TraverseDefaultStmt(DefaultStmt* Stmt)
 	return true;
 }
 
+bool DPrinter::isMallocAllocated(QualType const& type)
+{
+	return Options::getInstance().uniqueOwner
+	       and not type->isDependentType()
+	       and getSemantic(type) == TypeOptions::Value;
+}
+
 bool DPrinter::TraverseCXXDeleteExpr(CXXDeleteExpr* Expr)
 {
 	if(passStmt(Expr)) return true;
+	if(isMallocAllocated(Expr->getDestroyedType()))
+	{
+		out() << (Expr->isArrayForm() ? "cpp_std.deleteArray(" : "cpp_std.deleteValue(");
+		TraverseStmt(Expr->getArgument());
+		out() << ')';
+		addExternInclude("cpp_std", Expr->isArrayForm() ? "cpp_std.deleteArray" : "cpp_std.deleteValue");
+		return true;
+	}
 	TraverseStmt(Expr->getArgument());
 	out() << " = null";
 	return true;
@@ -1676,6 +2520,64 @@ bool DPrinter::TraverseCXXDeleteExpr(CXXDeleteExpr* Expr)
 bool DPrinter::TraverseCXXNewExpr(CXXNewExpr* Expr)
 {
 	if(passStmt(Expr)) return true;
+	QualType const allocatedType = Expr->getAllocatedType();
+	// new (std::nothrow) allocates too, unlike the placement new, which is never deleted
+	FunctionDecl const* operatorNew = Expr->getOperatorNew();
+	bool const allocates = Expr->getNumPlacementArgs() == 0
+	                       or (operatorNew and operatorNew->isReplaceableGlobalAllocationFunction());
+	if(allocates and isMallocAllocated(allocatedType))
+	{
+		if(Expr->isArray())
+		{
+			out() << "cpp_std.newArray!(";
+			printType(allocatedType);
+			out() << ")(";
+			TraverseStmt(Expr->getArraySize());
+			out() << ')';
+			addExternInclude("cpp_std", "cpp_std.newArray");
+			return true;
+		}
+		out() << "cpp_std.newValue!(";
+		printType(allocatedType);
+		out() << ")(";
+		switch(Expr->getInitializationStyle())
+		{
+		case CXXNewExpr::NoInit:
+			break;
+		case CXXNewExpr::CallInit:
+			if(CXXConstructExpr const* construct = Expr->getConstructExpr())
+				TraverseStmt(const_cast<CXXConstructExpr*>(construct));
+			else
+				TraverseStmt(Expr->getInitializer());
+			break;
+		case CXXNewExpr::ListInit: // new T{args} is built from T(args)
+			if(auto* list = dyn_cast<InitListExpr>(Expr->getInitializer()->IgnoreImplicit()))
+			{
+				if(list->getNumInits() != 0)
+				{
+					printType(allocatedType);
+					out() << '(';
+					Spliter spliter(*this, ", ");
+					for(clang::Expr* init : list->inits())
+					{
+						if(isa<ImplicitValueInitExpr>(init))
+							continue;
+						spliter.split();
+						TraverseStmt(init);
+					}
+					out() << ')';
+				}
+			}
+			else if(auto* construct = dyn_cast<CXXConstructExpr>(Expr->getInitializer()))
+				printCXXConstructExprParams(construct);
+			else
+				TraverseStmt(Expr->getInitializer());
+			break;
+		}
+		out() << ')';
+		addExternInclude("cpp_std", "cpp_std.newValue");
+		return true;
+	}
 	out() << "new ";
 	if(Expr->isArray())
 	{
@@ -1758,6 +2660,36 @@ bool DPrinter::TraverseCXXConstructExpr(CXXConstructExpr* Init)
 }
 
 void DPrinter::printType(QualType const& type)
+{
+	// Dependent types depend on the current template arguments,
+	// and variable arrays print an expression
+	if(isInMacro || not output_enabled ||
+	   type->isInstantiationDependentType() ||
+	   type->isVariablyModifiedType())
+	{
+		printTypeImpl(type);
+		return;
+	}
+
+	// Keyed by the type as written, since typedefs are printed by name
+	auto const key = std::make_pair(type.getAsOpaquePtr(), printFlags());
+	auto iter = typeCache.find(key);
+	if(iter == typeCache.end())
+	{
+		CachedPrint cached = recordImports([&]
+		{
+			pushStream();
+			printTypeImpl(type);
+			return popStream();
+		});
+		iter = typeCache.emplace(key, std::move(cached)).first;
+	}
+	else
+		replayImports(iter->second);
+	out() << iter->second.text;
+}
+
+void DPrinter::printTypeImpl(QualType const& type)
 {
 	if(type.getTypePtr()->getTypeClass() == clang::Type::TypeClass::Auto)
 	{
@@ -1835,7 +2767,7 @@ bool DPrinter::TraverseConstructorInitializer(CXXCtorInitializer* Init)
 					QualType fieldType = fieldDecl->getType().getCanonicalType();
 					initType.removeLocalConst();
 					fieldType.removeLocalConst();
-					if(fieldType == initType)
+					if(fieldType == initType and not ctor->getConstructor()->isMoveConstructor())
 					{
 						TraverseStmt(init);
 						out() << ".dup()";
@@ -1914,7 +2846,7 @@ void DPrinter::printSpecialMethodAttribute(CXXMethodDecl* Decl)
 	if(Decl->isStatic())
 		out() << "static ";
 	CXXRecordDecl* record = Decl->getParent();
-	if(record->isClass())
+	if(isDClass(record))
 	{
 		if(Decl->isPure())
 			out() << "abstract ";
@@ -1948,7 +2880,8 @@ bool DPrinter::printFuncBegin(CXXMethodDecl* Decl, std::string& tmpParams, int a
 		return false;
 	if(Decl->isImplicit())
 		return false;
-	if(Decl->isMoveAssignmentOperator())
+	// A **D** struct take the rvalues by value in opAssign. **D** class can't have opAssign.
+	if(Decl->isMoveAssignmentOperator() and isDClass(Decl->getParent()))
 		return false;
 	if(Decl->isOverloadedOperator()
 	   && Decl->getOverloadedOperator() == OverloadedOperatorKind::OO_ExclaimEqual)
@@ -2095,7 +3028,7 @@ bool DPrinter::printFuncBegin(CXXConstructorDecl* Decl,
 		return false;
 
 	CXXRecordDecl* record = Decl->getParent();
-	if(record->isStruct() || record->isUnion())
+	if(not isDClass(record))
 	{
 		if(Decl->isDefaultConstructor() && Decl->getNumParams() == 0)
 		{
@@ -2205,6 +3138,20 @@ void DPrinter::traverseFunctionDeclImpl(
 	}
 	if(not tmplPrinted and not tmplParamsStr.empty())
 		out() << '(' << tmplParamsStr << ')';
+	else if(not tmplPrinted)
+	{
+		// auto ref is only allowed in a template function
+		int paramIndex = 0;
+		for(ParmVarDecl* param : Decl->parameters())
+		{
+			if(paramIndex++ != arg_become_this
+			   and getParamPassing(param) == ParamPassing::AutoRef)
+			{
+				out() << "()";
+				break;
+			}
+		}
+	}
 	out() << "(";
 	inFuncParams = true;
 	bool isConstMethod = false;
@@ -2459,88 +3406,173 @@ bool DPrinter::TraverseBuiltinType(BuiltinType* Type)
 	return true;
 }
 
-TypeOptions::Semantic DPrinter::getSemantic(QualType qt)
+//! Does name start with one of the names
+template<typename Names>
+static bool startsWithAnyOf(std::string const& name, Names const& names)
 {
-	clang::Type const* type = qt.getTypePtr();
+	return std::any_of(std::begin(names), std::end(names), [&](auto && prefix)
+	{
+		return name.find(prefix) == 0;
+	});
+}
+
+DPrinter::TypeTraits DPrinter::computeTypeTraits(QualType const& canType)
+{
+	TypeTraits traits;
+	std::string const qualName = canType.getAsString();
+	static std::string const smartPtrNames[] =
+	{
+		"class std::shared_ptr<",
+		"class std::unique_ptr<",
+		"struct std::shared_ptr<",
+		"struct std::unique_ptr<",
+		"class boost::shared_ptr<",
+		"class boost::scoped_ptr<",
+		"struct boost::shared_ptr<",
+		"struct boost::scoped_ptr<",
+	};
+	traits.isSmartPointer = startsWithAnyOf(qualName, smartPtrNames);
+	static std::string const arrayNames[] =
+	{
+		"class boost::array<",
+		"class std::array<",
+		"struct boost::array<",
+		"struct std::array<"
+	};
+	traits.isStdArray = startsWithAnyOf(qualName, arrayNames);
+	static std::string const unorderedMapNames[] =
+	{
+		"class std::unordered_map<",
+		"class boost::unordered_map<",
+		"struct std::unordered_map<",
+		"struct boost::unordered_map<",
+	};
+	traits.isStdUnorderedMap = startsWithAnyOf(qualName, unorderedMapNames);
+	static std::string const stringNames[] =
+	{
+		"class std::basic_string<char,",
+		"class std::__cxx11::basic_string<char,",
+	};
+	traits.isStdString = startsWithAnyOf(qualName, stringNames);
+	if(RecordDecl const* record = canType->getAsRecordDecl())
+		traits.isDClass = isDClass(record);
+
 	std::string empty;
 	raw_string_ostream os(empty);
-	qt.getCanonicalType().getUnqualifiedType().print(os, printingPolicy);
+	canType.getUnqualifiedType().print(os, printingPolicy);
 	std::string const name = os.str();
 	// TODO : Externalize the semantic customization
-	if(name.find("class SafeInt<") == 0)
-		return TypeOptions::Value;
-	if(isStdArray(qt))
-		return TypeOptions::Value;
-	if(name.find("class std::basic_string<") == 0)
-		return TypeOptions::Value;
-	if(name.find("class std::__cxx11::basic_string<") == 0)
-		return TypeOptions::Value;
-	if(name.find("class boost::optional<") == 0)
-		return TypeOptions::Value;
-	if(name.find("class boost::property_tree::basic_ptree<") == 0)
-		return TypeOptions::Value;
-	if(name.find("class std::vector<") == 0)
-		return TypeOptions::Value;
-	if(name.find("class std::shared_ptr<") == 0)
-		return TypeOptions::Value;
-	if(name.find("class boost::scoped_ptr<") == 0)
-		return TypeOptions::Value;
-	if(name.find("class std::unique_ptr<") == 0)
-		return TypeOptions::Value;
-	if(isStdUnorderedMap(qt))
-		return TypeOptions::AssocArray;
-	if(name.find("class std::set<") == 0)
-		return TypeOptions::Value;
-	if(name.find("class std::unordered_set<") == 0)
-		return TypeOptions::Value;
-	if(name.find("class std::map<") == 0)
-		return TypeOptions::Value;
-	if(name.find("class std::multiset<") == 0)
-		return TypeOptions::Value;
-	if(name.find("class std::unordered_multiset<") == 0)
-		return TypeOptions::Value;
-	if(name.find("class std::multimap<") == 0)
-		return TypeOptions::Value;
-	if(name.find("class std::unordered_multimap<") == 0)
-		return TypeOptions::Value;
-
-	for(auto& nvp : Options::getInstance().types)
-	{
-		if(name.find(nvp.first) == 0)
-			return nvp.second.semantic;
+	static std::string const valueNames[] =
+	{
+		"class SafeInt<",
+		"class std::basic_string<",
+		"class std::__cxx11::basic_string<",
+		"class boost::optional<",
+		"class boost::property_tree::basic_ptree<",
+		"class std::vector<",
+		"class std::shared_ptr<",
+		"class boost::scoped_ptr<",
+		"class std::unique_ptr<",
+		"class std::set<",
+		"class std::unordered_set<",
+		"class std::map<",
+		"class std::multiset<",
+		"class std::unordered_multiset<",
+		"class std::multimap<",
+		"class std::unordered_multimap<",
+	};
+	traits.hasNamedSemantic = true;
+	if(traits.isStdArray)
+		traits.semantic = TypeOptions::Value;
+	else if(traits.isStdUnorderedMap)
+		traits.semantic = TypeOptions::AssocArray;
+	else if(startsWithAnyOf(name, valueNames))
+		traits.semantic = TypeOptions::Value;
+	else
+	{
+		auto const& types = Options::getInstance().types;
+		auto iter = std::find_if(std::begin(types), std::end(types), [&](auto && nvp)
+		{
+			return name.find(nvp.first) == 0;
+		});
+		if(iter != std::end(types))
+			traits.semantic = iter->second.semantic;
+		else
+			traits.hasNamedSemantic = false;
 	}
+	return traits;
+}
 
+DPrinter::TypeTraits const& DPrinter::getTypeTraits(QualType const& type)
+{
+	QualType const canType = type.getCanonicalType();
+	auto iter = typeTraitsCache.find(canType.getAsOpaquePtr());
+	if(iter == typeTraitsCache.end())
+		iter = typeTraitsCache.emplace(canType.getAsOpaquePtr(), computeTypeTraits(canType)).first;
+	return iter->second;
+}
+
+TypeOptions::Semantic DPrinter::getSemantic(QualType qt)
+{
+	TypeTraits const& traits = getTypeTraits(qt);
+	if(traits.hasNamedSemantic)
+		return traits.semantic;
+
+	clang::Type const* type = qt.getTypePtr();
 	if (auto *pt = dyn_cast<clang::PointerType>(type))
 		return getSemantic(pt->getPointeeType());
 	else
-		return (type->isClassType() || type->isFunctionType()) ? 
+		return (traits.isDClass || type->isFunctionType()) ?
 			TypeOptions::Reference : TypeOptions::Value;
 }
 
+bool DPrinter::isValueClass(CXXRecordDecl const* decl)
+{
+	if(not Options::getInstance().valueClasses)
+		return false;
+	decl = decl->getDefinition();
+	// Templates are printed once for all their specializations
+	if(decl == nullptr
+	   || not decl->isClass()
+	   || isa<ClassTemplateSpecializationDecl>(decl)
+	   || decl->getDescribedClassTemplate() != nullptr
+	   || decl->isDynamicClass()
+	   || decl->getNumBases() != 0
+	   || decl->getNumVBases() != 0)
+		return false;
+	// A D struct can't have a default ctor
+	for(CXXConstructorDecl const* ctor : decl->ctors())
+	{
+		if(ctor->isDefaultConstructor() && ctor->isUserProvided())
+			return false;
+	}
+	uint32_t const flags = SymbolIndex::getInstance().getRecordFlags(decl);
+	return (flags & (SymbolIndex::HasDerived | SymbolIndex::UsedByPointer)) == 0;
+}
+
+bool DPrinter::isDClass(RecordDecl const* decl)
+{
+	if(not decl->isClass())
+		return false;
+	auto* cxxRecordDecl = dyn_cast<CXXRecordDecl>(decl);
+	return cxxRecordDecl == nullptr || not isValueClass(cxxRecordDecl);
+}
+
+bool DPrinter::hasMoveAssignment(CXXRecordDecl const* decl)
+{
+	for(CXXMethodDecl const* method : decl->methods())
+	{
+		if(method->isMoveAssignmentOperator() && not method->isImplicit() && not method->isDeleted())
+			return true;
+	}
+	return false;
+}
+
 bool DPrinter::isPointer(QualType const& type)
 {
 	if(type->isPointerType())
 		return true;
-
-	QualType const rawType = type.isCanonical() ?
-	                         type :
-	                         type.getCanonicalType();
-	std::string const name = rawType.getAsString();
-	static std::string const arrayNames[] =
-	{
-		"class std::shared_ptr<",
-		"class std::unique_ptr<",
-		"struct std::shared_ptr<",
-		"struct std::unique_ptr<",
-		"class boost::shared_ptr<",
-		"class boost::scoped_ptr<",
-		"struct boost::shared_ptr<",
-		"struct boost::scoped_ptr<",
-	};
-	return std::any_of(std::begin(arrayNames), std::end(arrayNames), [&](auto && arrayName)
-	{
-		return name.find(arrayName) == 0;
-	});
+	return getTypeTraits(type).isSmartPointer;
 }
 
 
@@ -2695,10 +3727,206 @@ bool DPrinter::TraverseFriendDecl(FriendDecl* Decl)
 	return true;
 }
 
+DPrinter::ParamPassing DPrinter::getParamPassing(ParmVarDecl* decl)
+{
+	auto* func = dyn_cast<FunctionDecl>(decl->getDeclContext());
+	if(func == nullptr)
+		return ParamPassing::Copy;
+	auto* method = dyn_cast<CXXMethodDecl>(func);
+	if(method and method->getParent()->isLambda())
+		return ParamPassing::Copy;
+	auto* ctor = dyn_cast<CXXConstructorDecl>(func);
+	if(ctor and ctor->isCopyConstructor()) // Printed as a postblit
+		return ParamPassing::Copy;
+	// Forwarding reference : T&& where T is a parameter of this function template
+	if(auto* rvalueRef = decl->getType()->getAs<RValueReferenceType>())
+	{
+		QualType const pointee = rvalueRef->getPointeeType();
+		auto* tmplParm = dyn_cast<TemplateTypeParmType>(pointee.getTypePtr());
+		FunctionTemplateDecl* tmpl = func->getDescribedFunctionTemplate();
+		if(tmplParm and tmpl and not pointee.hasQualifiers()
+		   and tmplParm->getDepth() == tmpl->getTemplateParameters()->getDepth())
+			return ParamPassing::AutoRef;
+		return ParamPassing::Copy; // The caller move the argument
+	}
+	auto* refType = decl->getType()->getAs<LValueReferenceType>();
+	if(refType == nullptr)
+		return ParamPassing::Copy;
+	QualType const pointee = refType->getPointeeType();
+	if(not pointee.isConstQualified() or getSemantic(pointee) != TypeOptions::Value)
+		return ParamPassing::Copy;
+	// The rvalues go to the move assignment, taken by value (see printFuncBegin)
+	if(method and method->isCopyAssignmentOperator() and hasMoveAssignment(method->getParent()))
+		return ParamPassing::Ref;
+	// A copy is cheaper than a reference for small trivial types
+	if(not pointee->isDependentType() and not pointee->isIncompleteType()
+	   and Context->getTypeSize(pointee) <= 2 * Context->getTypeSize(Context->VoidPtrTy)
+	   and pointee.isTriviallyCopyableType(*Context))
+		return ParamPassing::Copy;
+
+	if(callSites == nullptr)
+	{
+		isMutableString(decl); // Compute mutableStrings
+		CallSiteCollector collector(*mutableStrings);
+		collector.TraverseDecl(Context->getTranslationUnitDecl());
+		callSites = std::make_unique<CallSites>();
+		callSites->addressTaken = std::move(collector.addressTaken);
+		callSites->unresolvedCalls = std::move(collector.unresolvedCalls);
+		callSites->rvalueArgs = std::move(collector.rvalueArgs);
+	}
+	FunctionDecl* const canon = func->getCanonicalDecl();
+	unsigned const index = decl->getFunctionScopeIndex();
+	bool const isVirtual = method and method->isVirtual();
+	bool const addressTaken = callSites->addressTaken.count(canon) != 0;
+	// Without external linkage, all call sites are in this translation unit
+	if(not isVirtual and not addressTaken
+	   and not func->isExternallyVisible()
+	   and not canon->getParamDecl(index)->hasDefaultArg()
+	   and callSites->unresolvedCalls.count(canon) == 0
+	   and callSites->rvalueArgs.count(std::make_pair(canon, index)) == 0)
+		return ParamPassing::Ref;
+	// A template can't be virtual, and its address need the template arguments.
+	// An other module could take the address of a visible function : it can't become a template.
+	bool const isTemplate = func->getDescribedFunctionTemplate() or func->isTemplateInstantiation();
+	if(not isVirtual and not addressTaken and func->isDefined()
+	   and (isTemplate or not func->isExternallyVisible()))
+		return ParamPassing::AutoRef;
+	return ParamPassing::Copy;
+}
+
+bool DPrinter::isMutableString(VarDecl const* decl)
+{
+	if(mutableStrings == nullptr)
+	{
+		mutableStrings = std::make_unique<std::unordered_set<VarDecl const*>>();
+		if(Options::getInstance().mutableStrings)
+		{
+			StringMutationCollector collector;
+			collector.TraverseDecl(Context->getTranslationUnitDecl());
+			for(VarDecl const* var : collector.mutated)
+			{
+				if(var->hasLocalStorage() and not isa<ParmVarDecl>(var)
+				   and not var->getType()->isReferenceType()
+				   and getTypeTraits(var->getType()).isStdString
+				   and collector.aliased.count(var) == 0)
+					mutableStrings->insert(var);
+			}
+		}
+	}
+	return mutableStrings->count(decl) != 0;
+}
+
+bool DPrinter::isMutableString(Expr const* expr)
+{
+	auto* declRef = dyn_cast<DeclRefExpr>(expr->IgnoreParenImpCasts());
+	auto* var = declRef ? dyn_cast<VarDecl>(declRef->getDecl()) : nullptr;
+	return var and isMutableString(var);
+}
+
+DPrinter::StringBoundary DPrinter::getStringBoundary(DeclRefExpr* expr)
+{
+	auto* var = dyn_cast<VarDecl>(expr->getDecl());
+	if(var == nullptr or not isMutableString(var))
+		return StringBoundary::None;
+	bool copied = false; // Given to a constructor, like the copy constructor of std::string
+	bool viaPointer = false; // Used through c_str() or data()
+	auto child = ast_type_traits::DynTypedNode::create(*expr);
+	while(true)
+	{
+		auto const parents = Context->getParents(child);
+		if(parents.empty())
+			return copied ? StringBoundary::Copy : StringBoundary::None;
+		ast_type_traits::DynTypedNode const& parent = parents[0];
+		if(auto* initVar = parent.get<VarDecl>())
+		{
+			// The range of a foreach is not copied, and an other mutable string is dup
+			if(initVar->isImplicit() or isMutableString(initVar) or (viaPointer and not copied))
+				return StringBoundary::None;
+			return StringBoundary::Copy;
+		}
+		// The string is not used after the return, except by a lambda which captured it
+		if(parent.get<ReturnStmt>())
+			return expr->refersToEnclosingVariableOrCapture() ? StringBoundary::Copy : StringBoundary::Unique;
+		Expr const* parentExpr = parent.get<Expr>();
+		if(parentExpr == nullptr)
+			return copied ? StringBoundary::Copy : StringBoundary::None;
+		if(isa<CXXConstructExpr>(parentExpr))
+			copied = true;
+		else if(auto* memberExpr = dyn_cast<MemberExpr>(parentExpr))
+		{
+			// s.c_str() is printed s (see cpp_stdlib_string_port) : Check the uses of the call
+			std::string const member = memberExpr->getMemberDecl()->getNameAsString();
+			if(member != "c_str" and member != "data")
+				return StringBoundary::None;
+			auto const callParents = Context->getParents(*memberExpr);
+			if(callParents.empty() or callParents[0].get<CXXMemberCallExpr>() == nullptr)
+				return StringBoundary::None;
+			viaPointer = true;
+			child = callParents[0];
+			continue;
+		}
+		else if(auto* opCall = dyn_cast<CXXOperatorCallExpr>(parentExpr))
+		{
+			// Only "t = s" need a string. "s[i]", "s += x", "t += s", "s == t", "s + t"... accept a char[]
+			if(opCall->getOperator() != OO_Equal or opCall->getArg(0) == child.get<Expr>())
+				return StringBoundary::None;
+			// An other mutable string is dup (see TraverseCXXOperatorCallExpr)
+			return isMutableString(opCall->getArg(0)) ? StringBoundary::None : StringBoundary::Copy;
+		}
+		// Each call taking a std::string (printed string) copy the char[]. Not a const char*.
+		else if(isa<CallExpr>(parentExpr))
+			return viaPointer and not copied ? StringBoundary::None : StringBoundary::Copy;
+		else if(not isa<ImplicitCastExpr>(parentExpr) and not isa<ParenExpr>(parentExpr)
+		        and not isa<MaterializeTemporaryExpr>(parentExpr) and not isa<CXXBindTemporaryExpr>(parentExpr)
+		        and not isa<ExprWithCleanups>(parentExpr))
+			return copied ? StringBoundary::Copy : StringBoundary::None;
+		child = parent;
+	}
+}
+
+bool DPrinter::isValueRead(Expr const* expr)
+{
+	auto child = ast_type_traits::DynTypedNode::create(*expr);
+	while(true)
+	{
+		auto const parents = Context->getParents(child);
+		if(parents.empty())
+			return false;
+		Expr const* parentExpr = parents[0].get<Expr>();
+		if(parentExpr == nullptr)
+			return false;
+		if(auto* cast = dyn_cast<ImplicitCastExpr>(parentExpr))
+		{
+			if(cast->getCastKind() == CK_LValueToRValue)
+				return true;
+			if(cast->getCastKind() != CK_NoOp) // Adding const
+				return false;
+		}
+		else if(auto* ctorExpr = dyn_cast<CXXConstructExpr>(parentExpr))
+			return ctorExpr->getConstructor()->isCopyConstructor();
+		else if(not isa<ParenExpr>(parentExpr))
+			return false;
+		child = parents[0];
+	}
+}
+
 bool DPrinter::TraverseParmVarDecl(ParmVarDecl* Decl)
 {
 	if(passDecl(Decl)) return true;
-	printType(Decl->getType());
+	switch(inFuncParams ? getParamPassing(Decl) : ParamPassing::Copy)
+	{
+	case ParamPassing::Copy:
+		printType(Decl->getType());
+		break;
+	case ParamPassing::Ref:
+		out() << "ref ";
+		printType(Decl->getType().getNonReferenceType());
+		break;
+	case ParamPassing::AutoRef:
+		out() << "auto ref ";
+		printType(Decl->getType().getNonReferenceType());
+		break;
+	}
 	std::string const name = getName(Decl->getDeclName());//getNameAsString();
 	if(name.empty() == false)
 		out() <<  " " << mangleName(name);
@@ -2945,9 +4173,13 @@ bool DPrinter::TraverseCXXOperatorCallExpr(CXXOperatorCallExpr* Stmt)
 		TypeOptions::Semantic const lo_sem = getSemantic(lo->getType());
 		TypeOptions::Semantic const ro_sem = getSemantic(ro->getType());
 
+		auto* assignOp = dyn_cast_or_null<CXXMethodDecl>(Stmt->getDirectCallee());
+		bool const isMove = assignOp && assignOp->isMoveAssignmentOperator();
+
 		bool const dup = //both operands will be transformed to pointer
 		  (ro_ptr == false && ro_sem != TypeOptions::Value) &&
-		  (lo_ptr == false && lo_sem != TypeOptions::Value);
+		  (lo_ptr == false && lo_sem != TypeOptions::Value) &&
+		  not isMove; // The reference is moved
 
 		if(dup)
 		{
@@ -2961,6 +4193,24 @@ bool DPrinter::TraverseCXXOperatorCallExpr(CXXOperatorCallExpr* Stmt)
 			out() << ".dup()";
 			isThisFunctionUsefull = true;
 		}
+		else if(isMutableString(lo))
+		{
+			// The new value of a char[] is a copy, so it can be modified in place
+			TraverseStmt(lo);
+			out() << " = ";
+			if(ro->IgnoreImpCasts()->getType()->isCharType())
+			{
+				out() << "[";
+				TraverseStmt(ro);
+				out() << "]";
+			}
+			else
+			{
+				out() << "(";
+				TraverseStmt(ro);
+				out() << ").dup";
+			}
+		}
 		else
 		{
 			TraverseStmt(lo);
@@ -3350,7 +4600,7 @@ bool DPrinter::TraverseLambdaExpr(LambdaExpr* Node)
 
 	if(hasAuto)
 	{
-		externIncludes["cpp_std"].insert("toFunctor");
+		addExternInclude("cpp_std", "toFunctor");
 		out() << "toFunctor!(";
 	}
 
@@ -3483,40 +4733,12 @@ bool DPrinter::TraverseCXXThisExpr(CXXThisExpr* expr)
 
 bool DPrinter::isStdArray(QualType const& type)
 {
-	QualType const rawType = type.isCanonical() ?
-	                         type :
-	                         type.getCanonicalType();
-	std::string const name = rawType.getAsString();
-	static std::string const arrayNames[] =
-	{
-		"class boost::array<",
-		"class std::array<",
-		"struct boost::array<",
-		"struct std::array<"
-	};
-	return std::any_of(std::begin(arrayNames), std::end(arrayNames), [&](auto && arrayName)
-	{
-		return name.find(arrayName) == 0;
-	});
+	return getTypeTraits(type).isStdArray;
 }
 
 bool DPrinter::isStdUnorderedMap(QualType const& type)
 {
-	QualType const rawType = type.isCanonical() ?
-	                         type :
-	                         type.getCanonicalType();
-	std::string const name = rawType.getAsString();
-	static std::string const arrayNames[] =
-	{
-		"class std::unordered_map<",
-		"class boost::unordered_map<",
-		"struct std::unordered_map<",
-		"struct boost::unordered_map<",
-	};
-	return std::any_of(std::begin(arrayNames), std::end(arrayNames), [&](auto && arrayName)
-	{
-		return name.find(arrayName) == 0;
-	});
+	return getTypeTraits(type).isStdUnorderedMap;
 }
 
 bool DPrinter::TraverseCXXDependentScopeMemberExpr(CXXDependentScopeMemberExpr* expr)
@@ -3567,7 +4789,7 @@ bool DPrinter::traverseMemberExprImpl(ME* Stmt)
 			else
 				out() << '.';
 		}
-		out() << memberName;
+		out() << mangleName(memberName);
 	}
 	auto TAL = Stmt->getTemplateArgs();
 	auto const tmpArgCount = Stmt->getNumTemplateArgs();
@@ -3586,32 +4808,16 @@ bool DPrinter::traverseMemberExprImpl(ME* Stmt)
 	return true;
 }
 
-//! @brief Is decl or parent of decl present in classes
+//! @brief Is a type of lineage (a class and its bases) present in classes
 //! @return The printer method found in classes
 MatchContainer::ClassPrinter::const_iterator::value_type::second_type
-isAnyOfThoseTypes(CXXRecordDecl* decl, MatchContainer::ClassPrinter const& classes)
+isAnyOfThoseTypes(std::vector<std::string> const& lineage, MatchContainer::ClassPrinter const& classes)
 {
-	std::string declName = decl->getQualifiedNameAsString();
-	size_t pos = declName.find('<');
-	if(pos != std::string::npos)
-		declName = declName.substr(0, pos);
-
-	auto classIter = classes.find(declName);
-	if(classIter != classes.end())
-		return classIter->second;
-	for(CXXBaseSpecifier const& baseSpec : decl->bases())
-	{
-		CXXRecordDecl* base = baseSpec.getType()->getAsCXXRecordDecl();
-		assert(base);
-		if(auto func = isAnyOfThoseTypes(base, classes))
-			return func;
-	}
-	for(CXXBaseSpecifier const& baseSpec : decl->vbases())
+	for(std::string const& declName : lineage)
 	{
-		CXXRecordDecl* base = baseSpec.getType()->getAsCXXRecordDecl();
-		assert(base);
-		if(auto func = isAnyOfThoseTypes(base, classes))
-			return func;
+		auto classIter = classes.find(declName);
+		if(classIter != classes.end())
+			return classIter->second;
 	}
 	return nullptr;
 };
@@ -3627,7 +4833,7 @@ bool DPrinter::TraverseCXXMemberCallExpr(CXXMemberCallExpr* expr)
 		auto methIter = receiver.methodPrinters.find(methName);
 		if(methIter != receiver.methodPrinters.end())
 		{
-			if(auto func = isAnyOfThoseTypes(thisType, methIter->second))
+			if(auto func = isAnyOfThoseTypes(getRecordTraits(thisType).lineage, methIter->second))
 			{
 				func(*this, expr);
 				return true;
@@ -3699,7 +4905,7 @@ bool DPrinter::TraverseBinAddAssign(CompoundAssignOperator* expr)
 		out() << ".popFrontN(";
 		TraverseStmt(expr->getRHS());
 		out() << ')';
-		externIncludes["std.range.primitives"].insert("popFrontN");
+		addExternInclude("std.range.primitives", "popFrontN");
 		return true;
 	}
 	else
@@ -3781,7 +4987,7 @@ bool DPrinter::TraverseUnaryOperator(UnaryOperator* Stmt)
 		{
 			TraverseStmt(Stmt->getSubExpr());
 			out() << ".popFront";
-			externIncludes["std.range.primitives"].insert("popFront");
+			addExternInclude("std.range.primitives", "popFront");
 			return true;
 		}
 	}
@@ -3906,10 +5112,19 @@ bool DPrinter::TraverseDeclRefExpr(DeclRefExpr* Expr)
 
 	std::string name = getName(Expr->getNameInfo().getName());
 	if(nestedNamePrined == false)
-		if(char const* filename = CPP2DTools::getFile(Context->getSourceManager(), Expr->getDecl()))
-			includeFile(filename, name);
+		includeFile(Expr->getDecl(), name);
+	StringBoundary const boundary = getStringBoundary(Expr);
+	if(boundary == StringBoundary::Unique)
+	{
+		out() << "std.exception.assumeUnique(";
+		addExternInclude("std.exception", "std.exception.assumeUnique");
+	}
 	out() << mangleName(name);
 	traverseDeclRefExprImpl(Expr);
+	if(boundary == StringBoundary::Unique)
+		out() << ')';
+	else if(boundary == StringBoundary::Copy)
+		out() << ".idup";
 	return true;
 }
 
@@ -3950,16 +5165,7 @@ bool DPrinter::TraverseRecordType(RecordType* Type)
 	{
 		// Print template arguments in template type of template specialization
 		auto* tmpSpec = llvm::dyn_cast<ClassTemplateSpecializationDecl>(decl);
-		TemplateArgumentList const& tmpArgsSpec = tmpSpec->getTemplateInstantiationArgs();
-		pushStream();
-		Spliter spliter2(*this, ", ");
-		for(unsigned int i = 0, size = tmpArgsSpec.size(); i != size; ++i)
-		{
-			spliter2.split();
-			TemplateArgument const& tmpArg = tmpArgsSpec.get(i);
-			printTemplateArgument(tmpArg);
-		}
-		printTmpArgList(popStream());
+		printTmpArgList(printTemplateArgs(tmpSpec->getTemplateInstantiationArgs()));
 		break;
 	}
 	default: assert(false && "Unconsustent RecordDecl kind");
@@ -4122,7 +5328,7 @@ bool DPrinter::TraverseUnresolvedMemberExpr(UnresolvedMemberExpr* expr)
 	}
 	if(NestedNameSpecifier* Qualifier = expr->getQualifier())
 		TraverseNestedNameSpecifier(Qualifier);
-	out() << expr->getMemberNameInfo().getAsString();
+	out() << mangleName(getName(expr->getMemberNameInfo().getName()));
 	traverseDeclRefExprImpl(expr);
 	return true;
 }
@@ -4162,11 +5368,15 @@ void DPrinter::traverseVarDeclImpl(VarDecl* Decl)
 			out() << "static ";
 		if(isRef)
 			out() << "auto";
+		else if(isMutableString(Decl))
+			out() << "char[]";
 		else
 			printType(varType);
 		out() << " ";
 	}
 	out() << mangleName(varName);
+	// The initial value of a mutable string is a string, or an other mutable string
+	bool const dupString = isMutableString(Decl);
 	bool const in_foreach_decl = inForRangeInit;
 	VarDecl* definition = Decl->hasInit() ? Decl : Decl->getDefinition();
 	if(definition && definition->hasInit() && !in_foreach_decl)
@@ -4183,9 +5393,13 @@ void DPrinter::traverseVarDeclImpl(VarDecl* Decl)
 						out() << " = ";
 						if(isRef)
 							out() << "makeRef(";
+						else if(dupString)
+							out() << "(";
 						printCXXConstructExprParams(constr);
 						if(isRef)
 							out() << ")";
+						else if(dupString)
+							out() << ").dup";
 					}
 				}
 				else if(getSemantic(varType) == TypeOptions::AssocArray)
@@ -4213,9 +5427,13 @@ void DPrinter::traverseVarDeclImpl(VarDecl* Decl)
 			out() << " = ";
 			if(isRef)
 				out() << "makeRef(";
+			else if(dupString)
+				out() << "(";
 			TraverseStmt(init);
 			if(isRef)
 				out() << ")";
+			else if(dupString)
+				out() << ").dup";
 		}
 	}
 }
@@ -4253,6 +5471,8 @@ bool DPrinter::VisitType(clang::Type* Type)
 void DPrinter::addExternInclude(std::string const& include, std::string const& typeName)
 {
 	externIncludes[include].insert(typeName);
+	for(ImportList* recorder : importRecorders)
+		recorder->emplace_back(include, typeName);
 }
 
 std::ostream& DPrinter::stream()
@@ -6,10 +6,14 @@
 //
 #pragma once
 
+#include <iosfwd>
+#include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <stack>
 #include <map>
 #include <set>
+#include <tuple>
 
 #pragma warning(push, 0)
 #pragma warning(disable: 4265)
@@ -29,11 +33,31 @@ class DPrinter : public clang::RecursiveASTVisitor<DPrinter>
 public:
 	explicit DPrinter(
 	  clang::ASTContext* Context,
-	  MatchContainer const& receiver,
+	  MatchContainer& receiver,
 	  llvm::StringRef file);
 
-	//! Set the list if #include found in the C++ source
-	void setIncludes(std::set<std::string> const& includes);
+	~DPrinter();
+
+	//! @brief Forget the traits of the types and records (see getTypeTraits and getRecordTraits)
+	//!
+	//! They are keyed by pointers of an ASTContext : Call it when the ASTContext change.
+	//! Called by the constructor and the destructor.
+	static void clearTraitsCaches();
+
+	//! Set the **D** module of each file included in the C++ source
+	void setIncludes(std::unordered_map<clang::FileEntry const*, std::string> const& includes);
+
+	//! @brief Reuse the **D** code of the unchanged top-level declarations
+	//!
+	//! The code of each declaration is saved in this file, with a fingerprint of its source and
+	//!   of the signatures of the declarations it uses.
+	void setDeclCacheFile(std::string const& path);
+
+	//! @brief Print the top-level declarations with many processes
+	//!
+	//! The processes are forked after the matching, and print the declarations in any order.
+	//! Their codes are then concatenated in the source order.
+	void setPrintJobs(unsigned jobs);
 
 	//! Get indentation string for a new line in **D** code
 	std::string indentStr() const;
@@ -83,7 +107,11 @@ public:
 	//! Print to **dlang** the clang::TemplateArgument ta
 	void printTemplateArgument(clang::TemplateArgument const& ta);
 
+	//! Print the template arguments of a specialization, separated by commas (cached)
+	std::string printTemplateArgs(clang::TemplateArgumentList const& tmpArgs);
+
 	//! Print the template part a of tmpl specialization. Like class A<b>(B = int, int = 2, C)</b>
+	//! @remark Cached by specialization
 	void printTemplateSpec_TmpArgsAndParms(
 	  clang::TemplateParameterList& primaryTmpParams, //!< Tmpl params of the specialized template
 	  clang::TemplateArgumentList const& tmpArgs, //!< Tmpl arguments of the specialization
@@ -96,8 +124,12 @@ public:
 	void printCXXConstructExprParams(clang::CXXConstructExpr* Init);
 
 	//! Print a type name to **dlang**
+	//! @remark Cached by type (as written) and printFlags, the needed imports are replayed
 	void printType(clang::QualType const& type);
 
+	//! Print a type name to **dlang** (not cached)
+	void printTypeImpl(clang::QualType const& type);
+
 	//! Trait printing the initialization list of the clang::FunctionDecl (nothing)
 	void startCtorBody(clang::FunctionDecl*);
 
@@ -207,6 +239,80 @@ public:
 	//! Check if decl is the type named baseName, or inherit from it directly or indirectly
 	static bool isA(clang::CXXRecordDecl* decl, std::string const& baseName);
 
+	//! Classification of a canonical type, computed once by type (see getTypeTraits)
+	struct TypeTraits
+	{
+		bool hasNamedSemantic = false; //!< If semantic is known by the type name (std, Options)
+		TypeOptions::Semantic semantic = TypeOptions::Value;
+		bool isSmartPointer = false;    //!< std/boost shared_ptr, unique_ptr, scoped_ptr
+		bool isStdArray = false;        //!< std::array or boost::array
+		bool isStdUnorderedMap = false; //!< std::unordered_map or boost::unordered_map
+		bool isStdString = false;       //!< std::string (basic_string of char)
+		bool isDClass = false;          //!< Printed as a **D** class (see isDClass)
+	};
+
+	//! Get the cached classification of the canonical type of type
+	static TypeTraits const& getTypeTraits(clang::QualType const& type);
+
+	//! Compute the classification of a canonical type
+	static TypeTraits computeTypeTraits(clang::QualType const& canType);
+
+	//! Inheritance info about a clang::CXXRecordDecl, computed once by decl
+	struct RecordTraits
+	{
+		//! Names (without template args) of the class and all its bases, in depth-first order
+		std::vector<std::string> lineage;
+		std::set<std::string> qualNames; //!< Qualified names of the class and all its bases
+	};
+
+	//! Get the cached inheritance info about decl
+	static RecordTraits const& getRecordTraits(clang::CXXRecordDecl* decl);
+
+	//! @brief True if this <b>C++</b> class can be printed as a **D** struct (Options::valueClasses)
+	//!
+	//! The class is never used polymorphically (no virtual, no base, no derived class),
+	//! never pointed nor allocated by new (see SymbolIndex::UsedByPointer), and has no default ctor.
+	static bool isValueClass(clang::CXXRecordDecl const* decl);
+
+	//! True if decl is printed as a **D** class
+	static bool isDClass(clang::RecordDecl const* decl);
+
+	//! True if decl has a user declared move assignment operator
+	static bool hasMoveAssignment(clang::CXXRecordDecl const* decl);
+
+	//! How a <b>C++</b> const reference parameter is passed in **D**
+	enum class ParamPassing
+	{
+		Copy,    //!< By value. Small types, or nothing better is possible.
+		Ref,     //!< **ref**. Every call site give a lvalue.
+		AutoRef, //!< **auto ref**. The function become a template.
+	};
+
+	//! @brief Choose how to pass this parameter in **D**
+	//!
+	//! Only const reference to value types are concerned, since **D** can't bind
+	//!  a rvalue to a **ref**. Call sites of the translation unit are checked to use **ref**.
+	ParamPassing getParamPassing(clang::ParmVarDecl* decl);
+
+	//! @brief True if new and delete of this type use malloc and free (Options::uniqueOwner)
+	//!
+	//! Only the value types are concerned (structs, scalars, arrays).
+	//! The classes stay on the GC heap.
+	static bool isMallocAllocated(clang::QualType const& type);
+
+	//! @brief True if this local std::string is printed as a <b>char[]</b> (Options::mutableStrings)
+	//!
+	//! Local strings appended, reserved or assigned by index are modified in place.
+	//! They are not bound to a non-const reference nor pointed.
+	bool isMutableString(clang::VarDecl const* decl);
+	//! True if this expression is a mutable string variable (see isMutableString)
+	bool isMutableString(clang::Expr const* expr);
+
+	//! @brief True if the value of this expression is only read
+	//!
+	//! Converted to a rvalue, or given to a copy constructor.
+	bool isValueRead(clang::Expr const* expr);
+
 	//  ******************** Function called by RecursiveASTVisitor *******************************
 	bool shouldVisitImplicitCode() const;
 
@@ -483,15 +589,98 @@ public:
 	std::set<clang::Expr*> dontTakePtr;    //!< Avoid to take pointer when implicit FunctionToPointerDecay
 
 private:
-	//! Add the import of for this file if it was included in the C++ file
-	void includeFile(std::string const& inclFile, std::string const& typeName);
+	//! Add the import of the file of decl if it was included in the C++ file
+	void includeFile(clang::Decl const* decl, std::string const& typeName);
 
 	//! Print the context (namespace, class, function) to **D**
 	void printDeclContext(clang::DeclContext* DC);
 
+	//! How a use of a mutable string (see isMutableString) is converted to **D** string
+	enum class StringBoundary
+	{
+		None,   //!< Used as char[] : modified, compared, concatenated...
+		Copy,   //!< Copied to a string : printed with <b>.idup</b>
+		Unique, //!< Returned by its function : printed with <b>assumeUnique</b>
+	};
+	//! Check if this use of a mutable string has to be converted to **D** string
+	StringBoundary getStringBoundary(clang::DeclRefExpr* expr);
+
 	//! Get type name and transform it for **D** printing
+	//! @remark Cached by decl, the needed imports are replayed on each call
 	std::string printDeclName(clang::NamedDecl* decl);
 
+	//! Get type name and transform it for **D** printing (not cached)
+	std::string printDeclNameImpl(clang::NamedDecl* decl);
+
+	//! Imports (module, hint) requested while printing something
+	typedef std::vector<std::pair<std::string, std::string> > ImportList;
+
+	//! Printed **D** code, with the imports needed by this code
+	struct CachedPrint
+	{
+		std::string text;
+		ImportList imports;
+	};
+
+	//! Call print and record all imports added during the call
+	template<typename PrintFunc>
+	CachedPrint recordImports(PrintFunc print);
+
+	//! Add again the imports needed by a cached code
+	void replayImports(CachedPrint const& cached);
+
+	//! Flags which change the way types are printed. Part of the cache keys.
+	unsigned printFlags() const;
+
+	//! printTemplateSpec_TmpArgsAndParms, without cache
+	void printTemplateSpec_TmpArgsAndParmsImpl(
+	  clang::TemplateParameterList& primaryTmpParams,
+	  clang::TemplateArgumentList const& tmpArgs,
+	  const clang::ASTTemplateArgumentListInfo* tmpArgsInfo,
+	  clang::TemplateParameterList* newTmpParams,
+	  std::string const& prevTmplParmsStr);
+
+	//! Code of the top-level declarations, by fingerprint (see setDeclCacheFile)
+	typedef std::map<std::string, CachedPrint> DeclCache;
+	//! Load the declCacheFile. Empty if the context (includes, options) changed.
+	DeclCache loadDeclCache() const;
+	//! Write the declCacheFile
+	void saveDeclCache(DeclCache const& cache) const;
+	//! Hash of what change the printing of all declarations (includes, options)
+	std::string getContextHash() const;
+	//! Write a CachedPrint in a stream
+	static void writeCachedPrint(std::ostream& os, CachedPrint const& code);
+	//! Read a CachedPrint written by writeCachedPrint
+	static bool readCachedPrint(std::istream& is, CachedPrint& code);
+
+	//! A top-level declaration, and the state of the printer before printing it
+	struct TopLevelDecl
+	{
+		clang::Decl* decl;
+		clang::SourceLocation locStart; //!< End of the previous declaration
+		int macroDepth;                 //!< isInMacro
+		size_t renameCount;             //!< renamedIdentifiers are the first renames
+		std::string fingerprint;        //!< Empty if not cached
+		bool cached;                    //!< code come from the declCacheFile
+		CachedPrint code;
+	};
+	//! Print a top-level declaration, with its comments since locStart
+	CachedPrint printTopLevelDecl(clang::Decl* decl, clang::SourceLocation locStart);
+	//! How isInMacro change after printing this top-level declaration
+	static int getMacroDepthChange(clang::Decl* decl);
+	//! Add the identifiers renamed when printing this declaration (see renamedIdentifiers)
+	static void collectRenamedIdentifiers(clang::Decl* decl,
+	                                      std::vector<clang::IdentifierInfo*>& renames);
+	//! Fill the code of the declarations which are not cached, using printJobs processes
+	void printInProcesses(std::vector<TopLevelDecl>& decls,
+	                      std::vector<clang::IdentifierInfo*> const& renames);
+	//! @brief Hash the source of decl, the comments before it (since locStart),
+	//!   and the signatures of the declarations it uses.
+	//! @return Empty if decl can't be fingerprinted (like in macro)
+	std::string getDeclFingerprint(clang::Decl* decl, clang::SourceLocation locStart);
+	//! Hash of the part of decl which can change the printing of its users
+	std::string const& getSignatureHash(clang::Decl const* decl);
+
 	//! Print the comment preceding this clang::Decl
 	void printCommentBefore(clang::Decl* t);
 
@@ -503,6 +692,9 @@ private:
 
 	static std::vector<std::string> split_lines(std::string const& instr);
 
+	//! Print the operator() of a std::hash specialization as the toHash method of the key
+	void printToHash(clang::CXXMethodDecl* hashMethod);
+
 	//! Print comment before a clang::Stmt
 	bool printStmtComment(
 	  clang::SourceLocation& locStart,      //!< IN/OUT Comment start (Will become nextStart)
@@ -540,6 +732,17 @@ private:
 		bool hasOpExclaim = false;   //!< If ```!a``` is valid
 		bool hasBoolConv = false;    //!< If has an operator ```operator bool()```
 	};
+	//! Declarations printed inside a record, which are not members in <b>C++</b>
+	struct RecordExtras
+	{
+		std::vector<clang::FunctionDecl*> leftOperators;  //!< Free operators taking the record first
+		std::vector<clang::FunctionDecl*> rightOperators; //!< Free operators taking it second only
+		clang::CXXMethodDecl* hashMethod = nullptr;       //!< operator() of its std::hash
+	};
+	//! @brief Get the free operators and hash trait of this record
+	//!
+	//! Matched in this module, or found by the SymbolIndex if defined in this translation unit
+	RecordExtras getRecordExtras(clang::RecordDecl const* decl);
 	//!< Using Custom matchers and custom printer (in MatchContainer) decide to custom print or not
 	bool passDecl(clang::Decl* decl);
 	//!< Using Custom matchers and custom printer (in MatchContainer) decide to custom print or not
@@ -547,11 +750,38 @@ private:
 	//!< Using Custom matchers and custom printer (in MatchContainer) decide to custom print or not
 	bool passType(clang::Type* type);
 
-	std::set<std::string> includesInFile;  //!< All includes find in the <b>C++</b> file
+	//! **D** module of all includes find in the <b>C++</b> file
+	std::unordered_map<clang::FileEntry const*, std::string> includedModules;
 	std::map<std::string, std::set<std::string> > externIncludes; //!< import to do in **D**
+	std::vector<ImportList*> importRecorders; //!< Imports added are also recorded here (see recordImports)
+	//! Cache of printDeclName, by decl and printFlags
+	std::map<std::pair<clang::NamedDecl const*, unsigned>, CachedPrint> declNameCache;
+	//! Cache of printType, by type (opaque pointer) and printFlags
+	std::map<std::pair<void*, unsigned>, CachedPrint> typeCache;
+	//! Cache of printTemplateArgs, by argument list and printFlags
+	std::map<std::pair<clang::TemplateArgumentList const*, unsigned>, CachedPrint> tmplArgsCache;
+	//! Cache of printTemplateSpec_TmpArgsAndParms, by its arguments and printFlags
+	std::map<std::tuple<clang::TemplateArgumentList const*,
+	    clang::ASTTemplateArgumentListInfo const*,
+	    clang::TemplateParameterList const*,
+	    std::string,
+	    unsigned>, CachedPrint> tmplSpecCache;
+	std::string declCacheFile; //!< Where to save the code of declarations. Empty if disabled.
+	unsigned printJobs = 1; //!< Processes printing the top-level declarations
+	std::unordered_map<clang::Decl const*, std::string> signatureHashes; //!< Cache of getSignatureHash
+	//! How the functions are used in the translation unit (see getParamPassing)
+	struct CallSites
+	{
+		std::unordered_set<clang::FunctionDecl const*> addressTaken;    //!< Used otherwise than called
+		std::unordered_set<clang::FunctionDecl const*> unresolvedCalls; //!< Called in a dependent context
+		std::set<std::pair<clang::FunctionDecl const*, unsigned>> rvalueArgs; //!< (function, param) given a rvalue
+	};
+	std::unique_ptr<CallSites> callSites; //!< Computed by the first getParamPassing
+	//! Computed by the first isMutableString
+	std::unique_ptr<std::unordered_set<clang::VarDecl const*>> mutableStrings;
 	std::string modulename; //!< Name of the <b>C++</b> module
 
-	MatchContainer const& receiver; //!< Custom matchers and custom printers
+	MatchContainer& receiver; //!< Custom matchers and custom printers
 	size_t indent = 0;              //!< Indentation level
 	clang::ASTContext* Context;
 	size_t isInMacro = 0;       //!< Disable printing if inside a macro expantion
@@ -571,4 +801,6 @@ private:
 	bool inTemplateParamList = false;
 	std::stack<std::string> catchedExceptNames;
 	static clang::PrintingPolicy printingPolicy;  //!< Policy for print to C++ (sometimes useful)
+	static std::unordered_map<void*, TypeTraits> typeTraitsCache; //!< By canonical type (opaque pointer)
+	static std::unordered_map<clang::CXXRecordDecl const*, RecordTraits> recordTraitsCache;
 };
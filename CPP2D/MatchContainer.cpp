@@ -11,6 +11,7 @@
 #include <ciso646>
 #include "CustomPrinters.h"
 #include "Spliter.h"
+#include "CPP2DTools.h"
 
 
 
@@ -148,10 +149,8 @@ void MatchContainer::cFuncPrinter(
 };
 
 
-clang::ast_matchers::MatchFinder MatchContainer::getMatcher()
+void MatchContainer::registerMatchers(MatchFinder& finder, std::set<std::string> const& includes)
 {
-	MatchFinder finder;
-
 	// Some debug bind slot
 	onStmtMatch.emplace("dump", [](Stmt const * d) {d->dump(); });
 	onTypeMatch.emplace("dump", [](Type const * d) {d->dump(); });
@@ -196,10 +195,52 @@ clang::ast_matchers::MatchFinder MatchContainer::getMatcher()
 		}
 	});
 
-	for(auto printerRegisterers : CustomPrinters::getInstance().getRegisterers())
+	for(auto printerRegisterers : CustomPrinters::getInstance().getRegisterers(includes))
 		printerRegisterers(*this, finder);
+}
 
-	return finder;
+void MatchContainer::matchModuleDecls(MatchFinder& finder_,
+                                      ASTContext& context_,
+                                      std::string const& modulename)
+{
+	finder = &finder_;
+	context = &context_;
+	matchedNodes.clear();
+	// Free operators and hash traits have to be known before printing the records.
+	for(Decl* decl : context_.getTranslationUnitDecl()->decls())
+	{
+		if(CPP2DTools::checkFilename(context_.getSourceManager(), modulename, decl))
+			matchDecl(decl);
+	}
+}
+
+template<typename Node>
+void MatchContainer::matchOnce(Node const& node, void const* nodePtr)
+{
+	if(finder == nullptr)
+		return;
+	if(matchedNodes.insert(nodePtr).second)
+		finder->match(node, *context);
+}
+
+void MatchContainer::matchDecl(Decl* decl)
+{
+	matchOnce(*decl, decl);
+	if(auto* friendDecl = dyn_cast<FriendDecl>(decl))
+	{
+		if(NamedDecl* friendFunc = friendDecl->getFriendDecl())
+			matchDecl(friendFunc);
+	}
+	else if(auto* tmpl = dyn_cast<TemplateDecl>(decl))
+	{
+		if(NamedDecl* templated = tmpl->getTemplatedDecl())
+			matchDecl(templated);
+	}
+	else if(isa<NamespaceDecl>(decl) || isa<LinkageSpecDecl>(decl) || isa<RecordDecl>(decl))
+	{
+		for(Decl* child : cast<DeclContext>(decl)->decls())
+			matchDecl(child);
+	}
 }
 
 void MatchContainer::run(const ast_matchers::MatchFinder::MatchResult& Result)
@@ -241,8 +282,9 @@ void MatchContainer::run(const ast_matchers::MatchFinder::MatchResult& Result)
 
 
 std::function<void(DPrinter& printer, clang::Stmt*)>
-MatchContainer::getPrinter(clang::Stmt const* node) const
+MatchContainer::getPrinter(clang::Stmt const* node)
 {
+	matchOnce(*node, node);
 	auto iter_pair = stmtTags.equal_range(node);
 	if(iter_pair.first != iter_pair.second)
 	{
@@ -255,8 +297,9 @@ MatchContainer::getPrinter(clang::Stmt const* node) const
 }
 
 std::function<void(DPrinter& printer, clang::Decl*)>
-MatchContainer::getPrinter(clang::Decl const* node) const
+MatchContainer::getPrinter(clang::Decl const* node)
 {
+	matchOnce(*node, node);
 	auto iter_pair = declTags.equal_range(node);
 	if(iter_pair.first != iter_pair.second)
 	{
@@ -269,8 +312,9 @@ MatchContainer::getPrinter(clang::Decl const* node) const
 }
 
 std::function<void(DPrinter& printer, clang::Type*)>
-MatchContainer::getPrinter(clang::Type const* node) const
+MatchContainer::getPrinter(clang::Type const* node)
 {
+	matchOnce(QualType(node, 0), node);
 	auto iter_pair = typeTags.equal_range(node);
 	if(iter_pair.first != iter_pair.second)
 	{
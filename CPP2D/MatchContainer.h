@@ -8,6 +8,7 @@
 
 #include <unordered_map>
 #include <unordered_set>
+#include <set>
 
 #pragma warning(push, 0)
 #pragma warning(disable: 4265)
@@ -21,6 +22,7 @@ namespace clang
 class Stmt;
 class Decl;
 class Type;
+class ASTContext;
 }
 
 //! Store matchers and receive the callbacks when the are find
@@ -31,8 +33,19 @@ class Type;
 class MatchContainer : public clang::ast_matchers::MatchFinder::MatchCallback
 {
 public:
-	//! Generate all ASTMatchers
-	clang::ast_matchers::MatchFinder getMatcher();
+	//! Generate the ASTMatchers and custom printers needed by the includes of the <b>C++</b> source
+	void registerMatchers(
+	  clang::ast_matchers::MatchFinder& finder, //!< Where to add the matchers
+	  std::set<std::string> const& includes  //!< All includes of the <b>C++</b> source
+	);
+
+	//! @brief Run the matchers on the declarations of the module (but not in function bodies)
+	//! The other nodes are matched lazily, when their printer is requested (getPrinter)
+	void matchModuleDecls(
+	  clang::ast_matchers::MatchFinder& finder, //!< Filled by registerMatchers
+	  clang::ASTContext& context,
+	  std::string const& modulename //!< Name of the <b>C++</b> module
+	);
 
 	//! Hash traits (std::hash) of this record. [recordname] -> method
 	std::unordered_map<std::string, clang::CXXMethodDecl const*> hashTraits;
@@ -48,9 +61,9 @@ public:
 	typedef std::function<void(DPrinter& printer, clang::Type*)> TypePrinter; //!< Custom Type printer
 
 
-	StmtPrinter getPrinter(clang::Stmt const*) const; //!< Get the custom printer for this statment
-	DeclPrinter getPrinter(clang::Decl const*) const; //!< Get the custom printer for this decl
-	TypePrinter getPrinter(clang::Type const*) const; //!< Get the custom printer for this type
+	StmtPrinter getPrinter(clang::Stmt const*); //!< Get the custom printer for this statment
+	DeclPrinter getPrinter(clang::Decl const*); //!< Get the custom printer for this decl
+	TypePrinter getPrinter(clang::Type const*); //!< Get the custom printer for this type
 
 	//! Get the nth template argument of type tmplType
 	static clang::TemplateArgument const* getTemplateTypeArgument(
@@ -137,4 +150,15 @@ public:
 private:
 	//! When match is find, excecute on*Match or add the node to *Tags
 	void run(clang::ast_matchers::MatchFinder::MatchResult const& Result) override;
+
+	//! Run the matchers on this node (but not on its children), if not already done
+	template<typename Node>
+	void matchOnce(Node const& node, void const* nodePtr);
+
+	//! Run the matchers on decl, and on the declarations nested in it (namespace, record...)
+	void matchDecl(clang::Decl* decl);
+
+	clang::ast_matchers::MatchFinder* finder = nullptr; //!< Matchers used by getPrinter
+	clang::ASTContext* context = nullptr;  //!< Context of the nodes to match
+	std::unordered_set<void const*> matchedNodes; //!< Nodes already matched
 };
\ No newline at end of file
@@ -20,6 +20,12 @@ struct TypeOptions
 struct Options
 {
 	std::unordered_map<std::string, TypeOptions> types;
+	//! Print as struct the classes which don't need the reference semantic (see DPrinter::isValueClass)
+	bool valueClasses = false;
+	//! Print as char[] the local strings modified in place (see DPrinter::isMutableString)
+	bool mutableStrings = false;
+	//! Allocate by malloc the structs and arrays of new and std::unique_ptr (see cpp_std.Unique)
+	bool uniqueOwner = false;
 
 	static Options& getInstance();
 };
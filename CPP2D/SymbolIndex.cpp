@@ -0,0 +1,413 @@
+//
+// Copyright (c) 2016 Loïc HAMOT
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "SymbolIndex.h"
+
+#include <fstream>
+#include <ciso646>
+
+#pragma warning(push, 0)
+#include <clang/AST/ASTConsumer.h>
+#include <clang/AST/RecursiveASTVisitor.h>
+#include <clang/Index/USRGeneration.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/Endian.h>
+#include <llvm/Support/MD5.h>
+#include <llvm/Support/MemoryBuffer.h>
+#pragma warning(pop)
+
+using namespace clang;
+
+namespace
+{
+uint32_t const IndexMagic = 0x49443243; //"C2DI"
+uint32_t const IndexVersion = 4;
+size_t const HeaderSize = 5 * 4;
+size_t const RecordSize = 5 * 4;
+size_t const LinkSize = 3 * 4;
+
+uint32_t read32(char const* ptr, size_t index)
+{
+	return llvm::support::endian::read32le(ptr + index * 4);
+}
+
+void write32(std::string& out, uint32_t value)
+{
+	char buffer[4];
+	llvm::support::endian::write32le(buffer, value);
+	out.append(buffer, 4);
+}
+
+//! True for the specializations std::hash<T>
+bool isHashTrait(ClassTemplateSpecializationDecl const* decl)
+{
+	return decl->getQualifiedNameAsString() == "std::hash" and decl->getTemplateArgs().size() == 1
+	       and decl->getTemplateArgs()[0].getKind() == TemplateArgument::Type;
+}
+
+//! True for the operators declared out of the records (see MatchContainer::freeOperator)
+bool isFreeOperator(FunctionDecl const* decl)
+{
+	return decl->getOverloadedOperator() != OO_None and not isa<CXXMethodDecl>(decl);
+}
+
+//! Get the record of this type, even if a pointer or a reference
+CXXRecordDecl const* getRecord(QualType type)
+{
+	type = type.getNonReferenceType();
+	if(type->isPointerType())
+		type = type->getPointeeType();
+	return type->getAsCXXRecordDecl();
+}
+
+//! Find free operators, hash traits, derived classes and pointers of the records
+class IndexCollector : public RecursiveASTVisitor<IndexCollector>
+{
+public:
+	explicit IndexCollector(SymbolIndexBuilder& builder)
+		: builder(builder)
+	{
+	}
+
+	bool VisitFunctionDecl(FunctionDecl* decl)
+	{
+		if(not isFreeOperator(decl) or decl->getNumParams() == 0)
+			return true;
+		CXXRecordDecl const* arg1Record = getRecord(decl->getParamDecl(0)->getType());
+		CXXRecordDecl const* arg2Record =
+		  decl->getNumParams() > 1 ? getRecord(decl->getParamDecl(1)->getType()) : nullptr;
+		if(arg1Record)
+			builder.addLinkFlags(arg1Record, decl, SymbolIndex::FreeOperator);
+		if(arg2Record and arg2Record != arg1Record)
+			builder.addLinkFlags(arg2Record, decl, SymbolIndex::FreeOperator | SymbolIndex::RightSide);
+		return true;
+	}
+
+	bool VisitClassTemplateSpecializationDecl(ClassTemplateSpecializationDecl* decl)
+	{
+		if(isHashTrait(decl))
+		{
+			if(CXXRecordDecl const* record = decl->getTemplateArgs()[0].getAsType()->getAsCXXRecordDecl())
+				builder.addLinkFlags(record, decl, SymbolIndex::HashTrait);
+		}
+		return true;
+	}
+
+	bool VisitCXXRecordDecl(CXXRecordDecl* decl)
+	{
+		if(not decl->hasDefinition())
+			return true;
+		for(CXXBaseSpecifier const& base : decl->bases())
+		{
+			if(CXXRecordDecl const* baseRecord = base.getType()->getAsCXXRecordDecl())
+				builder.addRecordFlags(baseRecord, SymbolIndex::HasDerived);
+		}
+		return true;
+	}
+
+	bool VisitPointerType(PointerType* type)
+	{
+		if(CXXRecordDecl const* record = type->getPointeeType()->getAsCXXRecordDecl())
+			builder.addRecordFlags(record, SymbolIndex::UsedByPointer);
+		return true;
+	}
+
+	bool VisitTemplateSpecializationType(TemplateSpecializationType* type)
+	{
+		TemplateDecl* tmpl = type->getTemplateName().getAsTemplateDecl();
+		if(tmpl == nullptr or type->getNumArgs() == 0)
+			return true;
+		std::string const name = tmpl->getQualifiedNameAsString();
+		if(name != "std::shared_ptr" and name != "std::unique_ptr" and name != "std::weak_ptr"
+		   and name != "boost::shared_ptr" and name != "boost::scoped_ptr")
+			return true;
+		TemplateArgument const& arg = type->getArg(0);
+		if(arg.getKind() == TemplateArgument::Type)
+		{
+			if(CXXRecordDecl const* record = arg.getAsType()->getAsCXXRecordDecl())
+				builder.addRecordFlags(record, SymbolIndex::UsedByPointer);
+		}
+		return true;
+	}
+
+	bool VisitCXXNewExpr(CXXNewExpr* expr)
+	{
+		if(CXXRecordDecl const* record = expr->getAllocatedType()->getAsCXXRecordDecl())
+			builder.addRecordFlags(record, SymbolIndex::UsedByPointer);
+		return true;
+	}
+
+private:
+	SymbolIndexBuilder& builder;
+};
+
+//! Find the definitions of the free operators and hash traits, by USR (see SymbolIndex::findLocalDefinition)
+class LocalDefinitionCollector : public RecursiveASTVisitor<LocalDefinitionCollector>
+{
+public:
+	std::map<std::string, Decl const*> definitions;
+
+	bool VisitFunctionDecl(FunctionDecl* decl)
+	{
+		if(isFreeOperator(decl) and decl->isThisDeclarationADefinition())
+			add(decl);
+		return true;
+	}
+
+	bool VisitClassTemplateSpecializationDecl(ClassTemplateSpecializationDecl* decl)
+	{
+		if(isHashTrait(decl) and decl->isThisDeclarationADefinition())
+			add(decl);
+		return true;
+	}
+
+private:
+	void add(Decl const* decl)
+	{
+		std::string usr = SymbolIndex::getUSR(decl);
+		if(not usr.empty())
+			definitions.emplace(std::move(usr), decl);
+	}
+};
+
+//! Call SymbolIndexBuilder::collect at the end of each translation unit
+class IndexConsumer : public ASTConsumer
+{
+public:
+	explicit IndexConsumer(SymbolIndexBuilder& builder)
+		: builder(builder)
+	{
+	}
+
+	void HandleTranslationUnit(ASTContext& context) override
+	{
+		builder.collect(context);
+	}
+
+private:
+	SymbolIndexBuilder& builder;
+};
+}
+
+SymbolIndex& SymbolIndex::getInstance()
+{
+	static SymbolIndex instance;
+	return instance;
+}
+
+SymbolIndex::~SymbolIndex() = default;
+
+bool SymbolIndex::load(std::string const& path)
+{
+	auto file = llvm::MemoryBuffer::getFile(path, -1, false); //Not null terminated => mmap
+	if(not file)
+		return false;
+	std::unique_ptr<llvm::MemoryBuffer> newBuffer = std::move(file.get());
+	char const* start = newBuffer->getBufferStart();
+	size_t const size = newBuffer->getBufferSize();
+	if(size < HeaderSize or read32(start, 0) != IndexMagic or read32(start, 1) != IndexVersion)
+		return false;
+	uint32_t const newRecordCount = read32(start, 2);
+	uint32_t const newLinkCount = read32(start, 3);
+	uint32_t const newStringsSize = read32(start, 4);
+	size_t const recordsStart = HeaderSize;
+	size_t const linksStart = recordsStart + size_t(newRecordCount) * RecordSize;
+	size_t const stringsStart = linksStart + size_t(newLinkCount) * LinkSize;
+	if(stringsStart + newStringsSize > size)
+		return false;
+
+	buffer = std::move(newBuffer);
+	recordCount = newRecordCount;
+	linkCount = newLinkCount;
+	stringsSize = newStringsSize;
+	records = start + recordsStart;
+	links = start + linksStart;
+	strings = start + stringsStart;
+
+	llvm::MD5 hasher;
+	hasher.update(buffer->getBuffer());
+	llvm::MD5::MD5Result result;
+	hasher.final(result);
+	contentHash = result.digest().str().str();
+	return true;
+}
+
+bool SymbolIndex::isLoaded() const
+{
+	return buffer != nullptr;
+}
+
+std::string const& SymbolIndex::getContentHash() const
+{
+	return contentHash;
+}
+
+llvm::StringRef SymbolIndex::getString(uint32_t offset, uint32_t size) const
+{
+	if(size_t(offset) + size > stringsSize)
+		return llvm::StringRef();
+	return llvm::StringRef(strings + offset, size);
+}
+
+bool SymbolIndex::findRecord(llvm::StringRef usr, Record& record) const
+{
+	if(usr.empty())
+		return false;
+	uint32_t first = 0;
+	uint32_t last = recordCount;
+	while(first < last)
+	{
+		uint32_t const middle = first + (last - first) / 2;
+		char const* entry = records + size_t(middle) * RecordSize;
+		int const cmp = getString(read32(entry, 0), read32(entry, 1)).compare(usr);
+		if(cmp == 0)
+		{
+			record.flags = read32(entry, 2);
+			record.firstLink = read32(entry, 3);
+			record.linkCount = read32(entry, 4);
+			return size_t(record.firstLink) + record.linkCount <= linkCount;
+		}
+		else if(cmp < 0)
+			first = middle + 1;
+		else
+			last = middle;
+	}
+	return false;
+}
+
+template<typename F>
+void SymbolIndex::forEachLink(Record const& record, F const& func) const
+{
+	for(uint32_t i = record.firstLink, end = record.firstLink + record.linkCount; i != end; ++i)
+	{
+		char const* entry = links + size_t(i) * LinkSize;
+		func(getString(read32(entry, 0), read32(entry, 1)), read32(entry, 2));
+	}
+}
+
+uint32_t SymbolIndex::getRecordFlags(CXXRecordDecl const* record) const
+{
+	uint32_t const localFlags = translationUnit ? translationUnit->getRecordFlags(record) : 0;
+	Record entry;
+	return findRecord(getUSR(record), entry) ? (entry.flags | localFlags) : localFlags;
+}
+
+void SymbolIndex::collectTranslationUnit(ASTContext& context)
+{
+	translationUnit = std::make_unique<SymbolIndexBuilder>();
+	translationUnit->collect(context);
+	LocalDefinitionCollector collector;
+	collector.TraverseDecl(context.getTranslationUnitDecl());
+	localDefinitions = std::move(collector.definitions);
+}
+
+std::vector<std::pair<std::string, uint32_t>> SymbolIndex::getLinks(
+  CXXRecordDecl const* record) const
+{
+	std::vector<std::pair<std::string, uint32_t>> result;
+	Record entry;
+	if(not findRecord(getUSR(record), entry))
+		return result;
+	forEachLink(entry, [&](llvm::StringRef linked, uint32_t flags)
+	{
+		result.emplace_back(linked.str(), flags);
+	});
+	return result;
+}
+
+Decl const* SymbolIndex::findLocalDefinition(std::string const& usr) const
+{
+	auto iter = localDefinitions.find(usr);
+	return iter == localDefinitions.end() ? nullptr : iter->second;
+}
+
+std::string SymbolIndex::getUSR(Decl const* decl)
+{
+	if(decl == nullptr)
+		return std::string();
+	llvm::SmallString<128> usr;
+	if(index::generateUSRForDecl(decl->getCanonicalDecl(), usr))
+		return std::string();
+	return usr.str().str();
+}
+
+void SymbolIndexBuilder::collect(ASTContext& context)
+{
+	IndexCollector collector(*this);
+	collector.TraverseDecl(context.getTranslationUnitDecl());
+}
+
+std::unique_ptr<ASTConsumer> SymbolIndexBuilder::newASTConsumer()
+{
+	return std::make_unique<IndexConsumer>(*this);
+}
+
+void SymbolIndexBuilder::addRecordFlags(CXXRecordDecl const* record, uint32_t flags)
+{
+	std::string usr = SymbolIndex::getUSR(record);
+	if(not usr.empty())
+		records[usr].flags |= flags;
+}
+
+uint32_t SymbolIndexBuilder::getRecordFlags(CXXRecordDecl const* record) const
+{
+	auto iter = records.find(SymbolIndex::getUSR(record));
+	return iter == records.end() ? 0 : iter->second.flags;
+}
+
+void SymbolIndexBuilder::addLinkFlags(CXXRecordDecl const* record,
+                                      Decl const* other,
+                                      uint32_t flags)
+{
+	std::string usr = SymbolIndex::getUSR(record);
+	std::string otherUSR = SymbolIndex::getUSR(other);
+	if(not usr.empty() and not otherUSR.empty())
+		records[usr].links[otherUSR] |= flags;
+}
+
+bool SymbolIndexBuilder::write(std::string const& path) const
+{
+	std::string strings;
+	llvm::StringMap<uint32_t> stringOffsets;
+	auto addString = [&](std::string const& str)
+	{
+		auto iter_inserted = stringOffsets.insert(std::make_pair(str, uint32_t(strings.size())));
+		if(iter_inserted.second)
+			strings += str;
+		return iter_inserted.first->getValue();
+	};
+
+	std::string recordTable;
+	std::string linkTable;
+	uint32_t linkCount = 0;
+	for(auto const& usr_n_record : records)
+	{
+		write32(recordTable, addString(usr_n_record.first));
+		write32(recordTable, uint32_t(usr_n_record.first.size()));
+		write32(recordTable, usr_n_record.second.flags);
+		write32(recordTable, linkCount);
+		write32(recordTable, uint32_t(usr_n_record.second.links.size()));
+		for(auto const& other_n_flags : usr_n_record.second.links)
+		{
+			write32(linkTable, addString(other_n_flags.first));
+			write32(linkTable, uint32_t(other_n_flags.first.size()));
+			write32(linkTable, other_n_flags.second);
+			++linkCount;
+		}
+	}
+
+	std::string header;
+	write32(header, IndexMagic);
+	write32(header, IndexVersion);
+	write32(header, uint32_t(records.size()));
+	write32(header, linkCount);
+	write32(header, uint32_t(strings.size()));
+
+	std::ofstream file(path, std::ios::binary);
+	file << header << recordTable << linkTable << strings;
+	return static_cast<bool>(file);
+}
@@ -0,0 +1,156 @@
+//
+// Copyright (c) 2016 Loïc HAMOT
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#pragma warning(push, 0)
+#include <llvm/ADT/StringRef.h>
+#pragma warning(pop)
+
+namespace clang
+{
+class ASTConsumer;
+class ASTContext;
+class Decl;
+class CXXRecordDecl;
+}
+
+namespace llvm
+{
+class MemoryBuffer;
+}
+
+class SymbolIndexBuilder;
+
+//! @brief Project-wide index of the free operators, hash traits and uses of the records
+//!
+//! The records are keyed by USR, which is the same in all translation units.
+//! The file is memory-mapped and queried read-only, without being deserialized.
+//!
+//! File format (all integers are 32 bits little endian) :
+//!  - header : magic, version, recordCount, linkCount, stringsSize
+//!  - records (sorted by USR) : usrOffset, usrSize, flags, firstLink, linkCount
+//!  - links : otherOffset, otherSize, flags
+//!  - strings
+class SymbolIndex
+{
+public:
+	//! Flags of a record
+	enum RecordFlags : uint32_t
+	{
+		HasDerived = 8,   //!< If an other record derive from it
+		UsedByPointer = 16, //!< If pointed by a pointer or a smart pointer, or allocated by new
+	};
+
+	//! Flags of a link between a record and an other symbol
+	enum LinkFlags : uint32_t
+	{
+		FreeOperator = 4, //!< other is a free operator of this record
+		RightSide = 8,    //!< The record is on the right side of this free operator
+		HashTrait = 16,   //!< other is the specialization of std::hash for this record
+	};
+
+	static SymbolIndex& getInstance();
+
+	~SymbolIndex();
+
+	//! Map the index file in memory
+	bool load(std::string const& path);
+
+	//! True if an index is loaded
+	bool isLoaded() const;
+
+	//! MD5 of the loaded index file, or an empty string
+	std::string const& getContentHash() const;
+
+	//! @brief Get the RecordFlags of this record (0 if unknown)
+	//! @remark Also include the flags found by collectTranslationUnit
+	uint32_t getRecordFlags(clang::CXXRecordDecl const* record) const;
+
+	//! @brief Collect the RecordFlags, free operators and hash traits of the current translation unit
+	//!
+	//! Called even if no index is loaded
+	void collectTranslationUnit(clang::ASTContext& context);
+
+	//! @brief Get the free operators and the hash trait of this record, in all translation units
+	//! @return [other USR] -> LinkFlags
+	std::vector<std::pair<std::string, uint32_t>> getLinks(clang::CXXRecordDecl const* record) const;
+
+	//! @brief Get by USR the definition of a free operator or of a std::hash specialization
+	//! found by collectTranslationUnit (nullptr if not defined in the current translation unit)
+	clang::Decl const* findLocalDefinition(std::string const& usr) const;
+
+	//! Get the USR of a declaration, or an empty string
+	static std::string getUSR(clang::Decl const* decl);
+
+private:
+	//! A record of the file
+	struct Record
+	{
+		uint32_t flags;
+		uint32_t firstLink;
+		uint32_t linkCount;
+	};
+
+	//! Binary search the record in the mapped file
+	bool findRecord(llvm::StringRef usr, Record& record) const;
+
+	//! Get the string at this offset of the string table
+	llvm::StringRef getString(uint32_t offset, uint32_t size) const;
+
+	//! Call func(other, flags) for each link of record
+	template<typename F>
+	void forEachLink(Record const& record, F const& func) const;
+
+	std::unique_ptr<llvm::MemoryBuffer> buffer; //!< The mapped file
+	std::string contentHash; //!< See getContentHash
+	std::unique_ptr<SymbolIndexBuilder> translationUnit; //!< See collectTranslationUnit
+	std::map<std::string, clang::Decl const*> localDefinitions; //!< See collectTranslationUnit
+	uint32_t recordCount = 0;
+	uint32_t linkCount = 0;
+	char const* records = nullptr;
+	char const* links = nullptr;
+	char const* strings = nullptr;
+	uint32_t stringsSize = 0;
+};
+
+//! Collect the data of SymbolIndex in many translation units, and write the file
+class SymbolIndexBuilder
+{
+public:
+	//! Add the data of this translation unit
+	void collect(clang::ASTContext& context);
+
+	//! Write the index file
+	bool write(std::string const& path) const;
+
+	//! Create a consumer which call collect (used by clang::tooling::newFrontendActionFactory)
+	std::unique_ptr<clang::ASTConsumer> newASTConsumer();
+
+	//! Add flags to this record
+	void addRecordFlags(clang::CXXRecordDecl const* record, uint32_t flags);
+
+	//! Get the flags collected for this record
+	uint32_t getRecordFlags(clang::CXXRecordDecl const* record) const;
+
+	//! Add flags to the link between record and other
+	void addLinkFlags(clang::CXXRecordDecl const* record, clang::Decl const* other, uint32_t flags);
+
+private:
+	//! Data about a record
+	struct Record
+	{
+		uint32_t flags = 0;
+		std::map<std::string, uint32_t> links; //!< [other USR] -> LinkFlags
+	};
+	std::map<std::string, Record> records; //!< [USR] -> Record (sorted as in the file)
+};
@@ -8,6 +8,7 @@
 #include "test.h"
 #include "stdlib_testsuite.h"
 #include "template_testsuite.h"
+#include "options_testsuite.h"
 
 int main(
 	int argc, char** argv
@@ -21,6 +22,7 @@ int main(
 	test_register(testFrameWork); 
 	stdlib_register(testFrameWork);
 	template_register(testFrameWork);
+	options_register(testFrameWork);
 	testFrameWork.run();
 
 	testFrameWork.print_results();
@@ -0,0 +1,145 @@
+//
+// Copyright (c) 2016 Loïc HAMOT
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "framework.h"
+#include <memory>
+
+// -mutable-strings
+
+std::string join_digits(int count)
+{
+	std::string result;
+	result.reserve(count);
+	for(int i = 0; i < count; ++i)
+		result += static_cast<char>('0' + i);
+	return result;
+}
+
+void check_string_append()
+{
+	std::string str = "ab";
+	str.push_back('c');
+	str.append("de");
+	str += "f";
+	str[0] = 'A';
+	CHECK(str == "Abcdef");
+	std::string const copy = str;
+	CHECK(copy.size() == 6);
+	CHECK(join_digits(4) == "0123");
+}
+
+void check_string_reassign()
+{
+	std::string const other = "xy";
+	std::string str = "ab";
+	str += "c";
+	str = "";
+	str += "d";
+	CHECK(str == "d");
+	str = other;
+	str[0] = 'X';
+	CHECK(str == "Xy");
+	CHECK(other == "xy");
+
+	std::string str2 = "12";
+	str2 += "3";
+	str = str2;
+	str += "4";
+	CHECK(str == "1234");
+	CHECK(str2 == "123");
+
+	str = 'z';
+	str += "!";
+	CHECK(str == "z!");
+}
+
+static std::size_t string_length(std::string const& str)
+{
+	return str.size();
+}
+
+void check_string_boundary()
+{
+	std::string str = "ab";
+	str += "c";
+	std::string const copy = str.c_str();
+	std::string const copy2 = str.data();
+	str += "d";
+	CHECK(copy == "abc");
+	CHECK(copy2 == "abc");
+	CHECK(string_length(str) == 4);
+	std::string other;
+	other = str.c_str();
+	CHECK(other == "abcd");
+}
+
+// -unique-owner
+
+struct OwnedValue
+{
+	int value = 0;
+};
+
+void check_unique_owner_new()
+{
+	OwnedValue* ptr = new OwnedValue();
+	ptr->value = 3;
+	CHECK_EQUAL(ptr->value, 3);
+	delete ptr;
+
+	OwnedValue* listInit = new OwnedValue{4};
+	CHECK_EQUAL(listInit->value, 4);
+	delete listInit;
+
+	int* values = new int[4];
+	values[3] = 7;
+	CHECK_EQUAL(values[3], 7);
+	delete[] values;
+}
+
+void check_unique_owner_ptr()
+{
+	std::unique_ptr<OwnedValue> owner = std::make_unique<OwnedValue>();
+	owner->value = 5;
+	CHECK_EQUAL((*owner).value, 5);
+	owner.reset(new OwnedValue{6});
+	CHECK_EQUAL(owner->value, 6);
+	OwnedValue* released = owner.release();
+	CHECK(owner == nullptr);
+	CHECK_EQUAL(released->value, 6);
+	delete released;
+	owner.reset(new OwnedValue());
+	CHECK(owner != nullptr);
+	owner.reset();
+	CHECK(owner == nullptr);
+
+	std::unique_ptr<int[]> values = std::make_unique<int[]>(3);
+	values[1] = 2;
+	CHECK_EQUAL(values[1], 2);
+	values.reset(new int[2]);
+	values[0] = 8;
+	CHECK_EQUAL(values[0], 8);
+	int* releasedValues = values.release();
+	CHECK(values == nullptr);
+	delete[] releasedValues;
+}
+
+void options_register(TestFrameWork& tf)
+{
+	auto ts = std::make_unique<TestSuite>();
+
+	ts->addTestCase(check_string_append);
+
+	ts->addTestCase(check_string_reassign);
+
+	ts->addTestCase(check_string_boundary);
+
+	ts->addTestCase(check_unique_owner_new);
+
+	ts->addTestCase(check_unique_owner_ptr);
+
+	tf.addTestSuite(std::move(ts));
+}
\ No newline at end of file
@@ -0,0 +1,10 @@
+//
+// Copyright (c) 2016 Loïc HAMOT
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "framework.h"
+
+//! Tests converted with the options changing the generated code (-mutable-strings, -unique-owner)
+void options_register(TestFrameWork& tf);
\ No newline at end of file
@@ -7,25 +7,53 @@
 #include <sstream>
 #include <unordered_map>
 #include <map>
+#include <set>
 #include <array>
 #include "framework.h"
 #include <cmath>
 #include "math.h"
 #include <iostream>
+#include <iomanip>
 
 template<typename T>
 struct TestType {};
 
 void check_std_map()
 {
-	/*std::map<int, int> m1;
+	std::map<int, int> m1;
 	m1[36] = 78;
 	CHECK_EQUAL(m1[36], 78);
 
 	auto m2 = m1;
 	m2[36] = 581;
 	CHECK_EQUAL(m2[36], 581);
-	CHECK_EQUAL(m1[36], 78);*/
+	CHECK_EQUAL(m1[36], 78);
+
+	m1[12] = 5;
+	CHECK_EQUAL(static_cast<int>(m1.count(12)), 1);
+	CHECK_EQUAL(m1.lower_bound(20)->first, 36);
+	CHECK_EQUAL(m1.upper_bound(12)->second, 78);
+	CHECK(m1.upper_bound(36) == m1.end());
+
+	// Lookups share the tree, writing through an iterator copies it
+	auto m3 = m1;
+	auto it = m3.find(12);
+	CHECK(it != m3.end());
+	CHECK_EQUAL(it->first, 12);
+	it->second = 6;
+	CHECK_EQUAL(m3.at(12), 6);
+	CHECK_EQUAL(m1.at(12), 5);
+	CHECK(m1.find(40) == m1.end());
+
+	// The iterator stays valid when its map is copied. Reading the value doesn't copy the tree.
+	auto it4 = m1.find(36);
+	auto m4 = m1;
+	int const read = it4->second;
+	CHECK_EQUAL(read, 78);
+	CHECK_EQUAL(it4->second + 1, 79);
+	it4->second = 79;
+	CHECK_EQUAL(m1.at(36), 79);
+	CHECK_EQUAL(m4.at(36), 78);
 
 	//auto lmbd = [](std::map<int, std::string> toto) {};
 	//auto lmbd2 = [](std::map<int, int>::value_type toto) {};
@@ -37,6 +65,22 @@ void check_std_map()
 	TestType<TestType<std::map<int, std::string>>> tata;
 }
 
+void check_std_set()
+{
+	std::set<int> s1;
+	s1.insert(3);
+	s1.insert(1);
+	s1.insert(3);
+	CHECK_EQUAL(static_cast<int>(s1.size()), 2);
+	CHECK_EQUAL(static_cast<int>(s1.count(3)), 1);
+
+	std::set<int> s2 = s1;
+	s2.erase(3);
+	CHECK_EQUAL(static_cast<int>(s2.count(3)), 0);
+	CHECK_EQUAL(static_cast<int>(s1.count(3)), 1);
+	CHECK_EQUAL(static_cast<int>(s1.size()), 2);
+}
+
 struct ContainHashMap
 {
 	std::unordered_map<int, int> m1;
@@ -122,6 +166,78 @@ void check_std_unordered_map()
 	}
 }
 
+struct HashedKey
+{
+	int a = 0;
+	int b = 0;
+
+	bool operator==(HashedKey const& other) const
+	{
+		return a == other.a && b == other.b;
+	}
+};
+
+namespace std
+{
+template<>
+struct hash<HashedKey>
+{
+	size_t operator()(HashedKey const& key) const
+	{
+		return static_cast<size_t>(key.a * 31 + key.b);
+	}
+};
+}
+
+void check_std_hash()
+{
+	std::unordered_map<HashedKey, int> m1;
+	HashedKey k1;
+	k1.a = 1;
+	k1.b = 2;
+	HashedKey k2;
+	k2.a = 2;
+	k2.b = 1;
+	m1[k1] = 12;
+	m1[k2] = 21;
+	CHECK_EQUAL(static_cast<int>(m1.size()), 2);
+	CHECK_EQUAL(m1.at(k1), 12);
+	CHECK_EQUAL(m1.at(k2), 21);
+	k2.b = 3;
+	CHECK(m1.find(k2) == m1.end());
+}
+
+void check_std_unordered_map_buckets()
+{
+	std::unordered_map<int, int> m1;
+	for(int i = 0; i < 100; ++i)
+		m1[i] = i * 2;
+	CHECK(m1.load_factor() <= m1.max_load_factor());
+
+	// Each erase shift back the next entries of its cluster
+	for(int i = 0; i < 100; i += 2)
+		CHECK_EQUAL(static_cast<int>(m1.erase(i)), 1);
+	CHECK_EQUAL(static_cast<int>(m1.erase(0)), 0);
+	CHECK_EQUAL(static_cast<int>(m1.size()), 50);
+	for(int i = 0; i < 100; ++i)
+		CHECK_EQUAL(static_cast<int>(m1.count(i)), i % 2);
+	for(int i = 1; i < 100; i += 2)
+		CHECK_EQUAL(m1.at(i), i * 2);
+
+	m1.reserve(1000);
+	std::size_t const reserved = m1.bucket_count();
+	CHECK(static_cast<float>(reserved) * m1.max_load_factor() >= 1000.f);
+	for(int i = 100; i < 1000; ++i)
+		m1[i] = i * 2;
+	CHECK(m1.bucket_count() == reserved);
+
+	m1.rehash(4096);
+	CHECK(m1.bucket_count() >= 4096);
+	CHECK_EQUAL(static_cast<int>(m1.size()), 950);
+	CHECK_EQUAL(m1.at(999), 1998);
+	CHECK_EQUAL(static_cast<int>(m1.count(98)), 0);
+}
+
 class Class781
 {
 public:
@@ -275,6 +391,19 @@ void check_vector()
 	CHECK_EQUAL(d.at(1)->i, 12);
 	CHECK_EQUAL(static_cast<int>(d.size()), 2);
 
+	std::vector<int> e;
+	e.reserve(10);
+	CHECK(e.capacity() >= 10);
+	e.resize(3, 7);
+	CHECK_EQUAL(e[2], 7);
+	e.insert(e.begin() + 1, 5);
+	CHECK_EQUAL(e[1], 5);
+	e.emplace_back(4);
+	CHECK_EQUAL(static_cast<int>(e.size()), 5);
+	CHECK_EQUAL(*e.data(), 7);
+	e.shrink_to_fit();
+	CHECK_EQUAL(e[4], 4);
+
 	std::cout << std::endl;
 }
 
@@ -302,6 +431,11 @@ void check_stringstream()
 
 	std::stringstream ss3("dfgdfgfh");
 	CHECK(ss3.str() == "dfgdfgfh");
+
+	std::stringstream ss4;
+	ss4 << std::hex << 255 << std::dec << ' ' << 10 << ' ' << std::setprecision(3) << 3.14159;
+	ss4 << ' ' << std::setw(4) << 7 << 8;
+	CHECK(ss4.str() == "ff 10 3.14    78");
 }
 
 void stdlib_register(TestFrameWork& tf)
@@ -312,12 +446,18 @@ void stdlib_register(TestFrameWork& tf)
 
 	ts->addTestCase(check_std_map);
 
+	ts->addTestCase(check_std_set);
+
 	ts->addTestCase(check_vector);
 
 	ts->addTestCase(check_cmath);
 
 	ts->addTestCase(check_std_unordered_map);
 
+	ts->addTestCase(check_std_hash);
+
+	ts->addTestCase(check_std_unordered_map_buckets);
+
 	ts->addTestCase(check_shared_ptr);
 
 	ts->addTestCase(check_unique_ptr);
@@ -92,6 +92,25 @@ void check_qualifier()
 	CHECK_EQUAL(QC<QA::B>::U, 18);
 }
 
+//! Members named like D keywords, used in a template
+struct KeywordMembers
+{
+	int scope = 4;
+	int body(int i) { return i; }
+	int body(double) { return -1; }
+};
+
+template<typename T>
+int use_keyword_members(T value)
+{
+	KeywordMembers members;
+	return members.body(value.scope); // An unresolved and a dependent member
+}
+
+void check_keyword_member_tmpl()
+{
+	CHECK_EQUAL(use_keyword_members(KeywordMembers()), 4);
+}
 
 void template_register(TestFrameWork& tf)
 {
@@ -105,5 +124,7 @@ void template_register(TestFrameWork& tf)
 
 	ts->addTestCase(check_return_ref_tmpl<char>);
 
+	ts->addTestCase(check_keyword_member_tmpl);
+
 	tf.addTestSuite(std::move(ts));
 }
\ No newline at end of file
@@ -2513,6 +2513,12 @@ void check_cast()
 	CHECK_EQUAL(i, 3);
 }
 
+struct KeywordMembers
+{
+	int scope = 0;
+	int unittest = 0;
+};
+
 void check_keyword_convertion()
 {
 	int version = 0;
@@ -2533,6 +2539,22 @@ void check_keyword_convertion()
 	CHECK_EQUAL(align, 0);
 	int Exception = 0;
 	CHECK_EQUAL(Exception, 0);
+	int body = 0;
+	CHECK_EQUAL(body, 0);
+	int module = 0;
+	CHECK_EQUAL(module, 0);
+	int alias = 0;
+	CHECK_EQUAL(alias, 0);
+	int immutable = 0;
+	CHECK_EQUAL(immutable, 0);
+	int real = 0;
+	CHECK_EQUAL(real, 0);
+	int is = 0;
+	CHECK_EQUAL(is, 0);
+	KeywordMembers km;
+	km.scope = 2;
+	km.unittest = 3;
+	CHECK_EQUAL(km.scope + km.unittest, 5);
 }
 
 enum 
@@ -2581,6 +2603,114 @@ void check_string_literal()
 	char b[] = "漢字";				// utf-8 (Need Unicode to be printed)
 }
 
+struct BigParam
+{
+	int values[8];
+};
+
+BigParam makeBigParam()
+{
+	BigParam param;
+	for(int i = 0; i < 8; ++i)
+		param.values[i] = i + 1;
+	return param;
+}
+
+// Only called with lvalues in this module : ref
+static int sumRefParam(BigParam const& param)
+{
+	int sum = 0;
+	for(int i = 0; i < 8; ++i)
+		sum += param.values[i];
+	return sum;
+}
+
+// Called with a rvalue in this module : auto ref
+static int sumAutoRefParam(BigParam const& param)
+{
+	return sumRefParam(param);
+}
+
+// Could be called from an other module : copy
+int sumCopiedParam(BigParam const& param)
+{
+	return sumRefParam(param);
+}
+
+// Called with a xvalue in this module : auto ref
+static int sumMovedParam(BigParam const& param)
+{
+	return sumRefParam(param);
+}
+
+template<typename T>
+int sumTmplParam(T const& param)
+{
+	int sum = 0;
+	for(int i = 0; i < 8; ++i)
+		sum += param.values[i];
+	return sum;
+}
+
+void check_const_ref_param()
+{
+	BigParam const param = makeBigParam();
+	CHECK(sumRefParam(param) == 36);
+	CHECK(sumAutoRefParam(param) == 36);
+	CHECK(sumAutoRefParam(makeBigParam()) == 36);
+	CHECK(sumCopiedParam(param) == 36);
+	CHECK(sumCopiedParam(makeBigParam()) == 36);
+	CHECK(sumTmplParam(param) == 36);
+	CHECK(sumTmplParam(makeBigParam()) == 36);
+	BigParam moved = makeBigParam();
+	CHECK(sumMovedParam(std::move(moved)) == 36);
+}
+
+struct MoveCounter
+{
+	int value = 0;
+	int moves = 0;
+
+	MoveCounter& operator=(MoveCounter&& other)
+	{
+		value = other.value;
+		moves = other.moves + 1;
+		return *this;
+	}
+};
+
+template<typename T>
+int sumForwarded(T&& param)
+{
+	return sumTmplParam(std::forward<T>(param));
+}
+
+void check_move()
+{
+	// lvalue : moved
+	BigParam source = makeBigParam();
+	BigParam dest = std::move(source);
+	CHECK(sumRefParam(dest) == 36);
+	// rvalue and const lvalue : copied
+	BigParam fromResult = std::move(makeBigParam());
+	CHECK(sumRefParam(fromResult) == 36);
+	BigParam const constParam = makeBigParam();
+	BigParam fromConst = std::move(constParam);
+	CHECK(sumRefParam(fromConst) == 36);
+	CHECK(sumRefParam(constParam) == 36);
+	// Move assignment
+	MoveCounter first;
+	first.value = 3;
+	MoveCounter second;
+	second = std::move(first);
+	CHECK(second.value == 3 && second.moves == 1);
+	second = MoveCounter();
+	CHECK(second.value == 0 && second.moves == 1);
+	// Perfect forwarding
+	CHECK(sumForwarded(dest) == 36);
+	CHECK(sumForwarded(makeBigParam()) == 36);
+}
+
 void test_register(TestFrameWork& tf)
 {
 	auto ts = std::make_unique<TestSuite>();
@@ -2703,5 +2833,9 @@ void test_register(TestFrameWork& tf)
 
 	ts->addTestCase(check_not_array_ptr);
 
+	ts->addTestCase(check_const_ref_param);
+
+	ts->addTestCase(check_move);
+
 	tf.addTestSuite(std::move(ts));
 }
\ No newline at end of file
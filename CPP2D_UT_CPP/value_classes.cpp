@@ -0,0 +1,16 @@
+//
+// Copyright (c) 2016 Loïc HAMOT
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "value_classes.h"
+
+int use_value_classes()
+{
+	ValueClass byValue;
+	byValue.value = 2;
+	PointedClass alsoByValue;
+	alsoByValue.value = 3;
+	return byValue.twice() + alsoByValue.value;
+}
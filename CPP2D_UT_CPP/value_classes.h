@@ -0,0 +1,29 @@
+//
+// Copyright (c) 2016 Loïc HAMOT
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Converted by the CI with -value-classes and the index of value_classes*.cpp
+
+//! Only used by value : become a D struct
+class ValueClass
+{
+public:
+	int value = 0;
+
+	int twice() const
+	{
+		return value * 2;
+	}
+};
+
+//! Used by value here, but pointed in value_classes_pointer.cpp : stay a D class
+class PointedClass
+{
+public:
+	int value = 0;
+};
+
+int use_value_classes();
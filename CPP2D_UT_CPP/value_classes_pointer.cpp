@@ -0,0 +1,12 @@
+//
+// Copyright (c) 2016 Loïc HAMOT
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "value_classes.h"
+
+PointedClass* make_pointed()
+{
+	return new PointedClass();
+}